@@ -0,0 +1,93 @@
+#ifndef GUARD_BATCHEDTREEWRITER_H
+#define GUARD_BATCHEDTREEWRITER_H
+
+// system include files
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// user include files
+#include <TTree.h>
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeBranchBinder.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
+
+using namespace std;
+
+
+/*
+ * Single writer for a tree that is filled from several streams.
+ *
+ * The record type must provide branch(TreeBranchBinder&), clear() and sortKey(). Streams fill their own records and hand them over
+ * in batches; the writer swaps each record into the instance that is bound to the tree branches and fills the tree. All
+ * tree access is serialized with the mutex that guards the output file of the TFileService.
+ *
+ * With deterministic ordering each batch is written sorted by the sort key of its records, i.e. the rows are only sorted
+ * within a batch. The order within a batch does not depend on the scheduling of the streams if the caller hands over
+ * complete windows of records, e.g. all records of a luminosity block; the order of the batches is the order of the
+ * calls. The writer itself keeps no records.
+ */
+template <typename Record>
+class BatchedTreeWriter {
+
+public:
+    BatchedTreeWriter();
+
+    void book(TTree*, const bool&, const TreeLayout& = TreeLayout::vectorBranches);
+    void write(vector<Record>&, const size_t&);
+
+private:
+    void fill(Record&);
+
+    TTree* tree_;
+    TreeBranchBinder binder_;
+    Record record_;
+    bool deterministicOrder_;
+}; // end class BatchedTreeWriter
+
+
+template <typename Record>
+BatchedTreeWriter<Record>::BatchedTreeWriter() {
+    tree_ = nullptr;
+    deterministicOrder_ = false;
+}
+
+
+template <typename Record>
+void BatchedTreeWriter<Record>::book(TTree* tree, const bool& deterministicOrder, const TreeLayout& layout) {
+    tree_ = tree;
+    deterministicOrder_ = deterministicOrder;
+    binder_ = TreeBranchBinder(tree_, layout);
+    record_.branch(binder_);
+}
+
+
+template <typename Record>
+void BatchedTreeWriter<Record>::write(vector<Record>& records, const size_t& nRecords) {
+    // the batch is sorted by the caller's thread before the output file is locked
+    if (deterministicOrder_) {
+        stable_sort(
+            records.begin(),
+            records.begin() + nRecords,
+            [] (const Record& r1, const Record& r2) { return r1.sortKey() < r2.sortKey(); }
+        );
+    }
+
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
+    for (size_t i = 0; i < nRecords; ++i) {
+        fill(records[i]);
+    }
+}
+
+
+template <typename Record>
+void BatchedTreeWriter<Record>::fill(Record& record) {
+    // the branch addresses point to the members of record_, swapping only exchanges the buffers of the columns
+    swap(record_, record);
+    binder_.prepare();
+    tree_->Fill();
+}
+
+
+#endif // end GUARD_BATCHEDTREEWRITER_H
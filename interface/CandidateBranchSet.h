@@ -0,0 +1,225 @@
+#ifndef GUARD_CANDIDATEBRANCHSET_H
+#define GUARD_CANDIDATEBRANCHSET_H
+
+// system include files
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// user include files
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeBranchBinder.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
+
+using namespace std;
+
+
+namespace candidate_fields {
+
+
+/*
+ * Descriptors of the columns that are written for a candidate. A descriptor provides the suffix of the branch name, the
+ * stored type and the getter that is applied to the candidate. Descriptors that can be stored with a lower precision
+ * also provide reduce(), which is only applied on request.
+ */
+
+struct Pt {
+    static constexpr const char* name = "Pt";
+    typedef float value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.pt(); }
+};
+
+
+struct Eta {
+    static constexpr const char* name = "Eta";
+    typedef float value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.eta(); }
+};
+
+
+struct Phi {
+    static constexpr const char* name = "Phi";
+    typedef float value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.phi(); }
+};
+
+
+struct Mass {
+    static constexpr const char* name = "Mass";
+    typedef float value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.mass(); }
+};
+
+
+struct Charge {
+    static constexpr const char* name = "Charge";
+    typedef int value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.charge(); }
+};
+
+
+struct PdgId {
+    static constexpr const char* name = "PdgId";
+    typedef int value_type;
+    template <typename T> static value_type get(const T& candidate) { return candidate.pdgId(); }
+};
+
+
+// floating point column that is filled with full precision and whose mantissa can be rounded to the given number of bits
+// before it is stored, the reduced entropy of the lower bits makes the column compress much better
+template <typename Field, int MantissaBits>
+struct Reducible {
+    static constexpr const char* name = Field::name;
+    typedef float value_type;
+    template <typename T> static value_type get(const T& candidate) { return Field::get(candidate); }
+    static value_type reduce(const value_type& value) { return util::reduceMantissa<MantissaBits>(value); }
+};
+
+
+// whether a descriptor can be stored with a lower precision
+template <typename Field, typename = void>
+struct isReducible : false_type {};
+
+
+template <typename Field>
+struct isReducible<Field, void_t<decltype(Field::reduce(declval<typename Field::value_type>()))>> : true_type {};
+
+
+}; // end namespace candidate_fields
+
+
+/*
+ * Group of branches with one column per field descriptor, named by a common prefix and the suffix of the field.
+ *
+ * Registration, reservation and filling are generated from the field list, the columns of a collection are filled in a
+ * single pass over its candidates. All columns are filled with full precision, reducePrecision() rounds the filled
+ * values of the reducible columns.
+ */
+template <typename T, typename... Fields>
+class CandidateBranchSet {
+
+public:
+    CandidateBranchSet(const string&);
+
+    void branch(TreeBranchBinder&);
+    void clear();
+    void reserve(const size_t&);
+    void push_back(const T&);
+    template <typename Collection> void fill(const Collection&);
+    void reducePrecision();
+    const size_t size() const;
+
+private:
+    template <size_t... Is> void branch(TreeBranchBinder&, index_sequence<Is...>);
+    template <size_t... Is> void clear(index_sequence<Is...>);
+    template <size_t... Is> void reserve(const size_t&, index_sequence<Is...>);
+    template <size_t... Is> void push_back(const T&, index_sequence<Is...>);
+    template <size_t... Is> void reducePrecision(index_sequence<Is...>);
+    template <typename Field> static void reduceColumn(vector<typename Field::value_type>&);
+
+    string prefix_;
+    tuple<vector<typename Fields::value_type>...> columns_;
+}; // end class CandidateBranchSet
+
+
+template <typename T, typename... Fields>
+CandidateBranchSet<T, Fields...>::CandidateBranchSet(const string& prefix) {
+    prefix_ = prefix;
+}
+
+
+template <typename T, typename... Fields>
+void CandidateBranchSet<T, Fields...>::branch(TreeBranchBinder& binder) {
+    branch(binder, index_sequence_for<Fields...>());
+}
+
+
+template <typename T, typename... Fields>
+void CandidateBranchSet<T, Fields...>::clear() {
+    clear(index_sequence_for<Fields...>());
+}
+
+
+template <typename T, typename... Fields>
+void CandidateBranchSet<T, Fields...>::reserve(const size_t& size) {
+    reserve(size, index_sequence_for<Fields...>());
+}
+
+
+template <typename T, typename... Fields>
+void CandidateBranchSet<T, Fields...>::push_back(const T& candidate) {
+    push_back(candidate, index_sequence_for<Fields...>());
+}
+
+
+template <typename T, typename... Fields>
+template <typename Collection>
+void CandidateBranchSet<T, Fields...>::fill(const Collection& candidates) {
+    reserve(size() + candidates.size());
+    for (const T& candidate : candidates) {
+        push_back(candidate);
+    }
+}
+
+
+template <typename T, typename... Fields>
+void CandidateBranchSet<T, Fields...>::reducePrecision() {
+    reducePrecision(index_sequence_for<Fields...>());
+}
+
+
+template <typename T, typename... Fields>
+const size_t CandidateBranchSet<T, Fields...>::size() const {
+    return get<0>(columns_).size();
+}
+
+
+template <typename T, typename... Fields>
+template <size_t... Is>
+void CandidateBranchSet<T, Fields...>::branch(TreeBranchBinder& binder, index_sequence<Is...>) {
+    // all columns of the set belong to the collection named by the prefix
+    (binder.addColumn(prefix_, prefix_ + Fields::name, &get<Is>(columns_)), ...);
+}
+
+
+template <typename T, typename... Fields>
+template <size_t... Is>
+void CandidateBranchSet<T, Fields...>::clear(index_sequence<Is...>) {
+    (get<Is>(columns_).clear(), ...);
+}
+
+
+template <typename T, typename... Fields>
+template <size_t... Is>
+void CandidateBranchSet<T, Fields...>::reserve(const size_t& size, index_sequence<Is...>) {
+    (get<Is>(columns_).reserve(size), ...);
+}
+
+
+template <typename T, typename... Fields>
+template <size_t... Is>
+void CandidateBranchSet<T, Fields...>::push_back(const T& candidate, index_sequence<Is...>) {
+    (get<Is>(columns_).push_back(Fields::get(candidate)), ...);
+}
+
+
+template <typename T, typename... Fields>
+template <size_t... Is>
+void CandidateBranchSet<T, Fields...>::reducePrecision(index_sequence<Is...>) {
+    (reduceColumn<Fields>(get<Is>(columns_)), ...);
+}
+
+
+template <typename T, typename... Fields>
+template <typename Field>
+void CandidateBranchSet<T, Fields...>::reduceColumn(vector<typename Field::value_type>& column) {
+    if constexpr (candidate_fields::isReducible<Field>::value) {
+        for (typename Field::value_type& value : column) {
+            value = Field::reduce(value);
+        }
+    }
+}
+
+
+#endif // end GUARD_CANDIDATEBRANCHSET_H
@@ -0,0 +1,93 @@
+#ifndef GUARD_FILTEREFFICIENCYHISTOGRAMS_H
+#define GUARD_FILTEREFFICIENCYHISTOGRAMS_H
+
+// system include files
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// user include files
+#include "CommonTools/UtilAlgos/interface/TFileDirectory.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+using namespace std;
+
+
+// bin edges of the pt, eta and decay mode axes of the efficiency histograms
+struct EfficiencyBinning {
+    vector<double> ptBins;
+    vector<double> etaBins;
+    vector<double> decayModeBins;
+};
+
+
+/*
+ * Weighted counts in pt, eta and decay mode, laid out like the bins of a TH3 including under- and overflow.
+ */
+class EfficiencyCounts {
+
+public:
+    EfficiencyCounts();
+    EfficiencyCounts(const shared_ptr<const EfficiencyBinning>&);
+
+    void fill(const double&, const double&, const double&, const double&);
+    void add(const EfficiencyCounts&);
+    const vector<double>& sumWeights() const;
+    const vector<double>& sumWeights2() const;
+
+private:
+    static const size_t findBin(const vector<double>&, const double&);
+
+    shared_ptr<const EfficiencyBinning> binning_;
+    vector<double> sumWeights_;
+    vector<double> sumWeights2_;
+}; // end class EfficiencyCounts
+
+
+// slots of the count keys, shared by all copies of a FilterEfficiencyHistograms instance
+struct EfficiencyKeyTable {
+    mutex keysMutex;
+    unordered_map<string, size_t> slots;
+    vector<string> keys;
+};
+
+
+/*
+ * Numerator and denominator counts of the saveTags filters of HLT paths for the legs of the offline pair.
+ *
+ * The counts are named by a key 'path/filter', with 'path/denominator' for the denominator of a path, and hold one set
+ * of counts per configured leg type. Keys are resolved to integer slots with slot(), e.g. once per run, and the counts
+ * are filled by slot; the slots are shared by all copies of an instance, so that the counts of the copies line up. Every
+ * stream fills its own copy, the copies are merged at the end of the streams and written as TH3D histograms into one
+ * directory per path.
+ */
+class FilterEfficiencyHistograms {
+
+public:
+    FilterEfficiencyHistograms();
+    FilterEfficiencyHistograms(const edm::ParameterSet&);
+
+    const bool enabled() const;
+    const vector<string>& legs() const;
+    const int legIndex(const string&) const;
+    const size_t slot(const string&) const;
+
+    void fill(const size_t&, const size_t&, const double&, const double&, const double&, const double&);
+    void merge(const FilterEfficiencyHistograms&);
+    void write(TFileDirectory&) const;
+
+    static const string denominatorKey(const string&);
+    static const string filterKey(const string&, const string&);
+
+private:
+    bool enabled_;
+    vector<string> legs_;
+    shared_ptr<const EfficiencyBinning> binning_;
+    shared_ptr<EfficiencyKeyTable> keyTable_;
+    vector<vector<EfficiencyCounts>> counts_;
+}; // end class FilterEfficiencyHistograms
+
+
+#endif // end GUARD_FILTEREFFICIENCYHISTOGRAMS_H
@@ -0,0 +1,69 @@
+#ifndef GUARD_GENDECAYTREE_H
+#define GUARD_GENDECAYTREE_H
+
+// system include files
+#include <cstdint>
+#include <vector>
+
+// user include files
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+
+namespace tautau_selection_gen {
+
+
+// contiguous range of particle indices of a GenDecayTree
+class GenIndexRange {
+
+public:
+    GenIndexRange(const uint32_t*, const uint32_t*);
+
+    const uint32_t* begin() const;
+    const uint32_t* end() const;
+    const size_t size() const;
+    const uint32_t operator[](const size_t&) const;
+
+private:
+    const uint32_t* begin_;
+    const uint32_t* end_;
+}; // end class GenIndexRange
+
+
+/*
+ * Flat index of a generator record, e.g. prunedGenParticles, built once per event.
+ *
+ * Particles are identified by their index in the record. The PDG IDs, charges and status flag bits (see
+ * reco::GenStatusFlags::StatusBits) are kept in one array each, so that scans over them do not touch the particles; the
+ * mothers and daughters of particle i are stored contiguously and delimited by offset arrays. The last copy of every
+ * particle, found by following the daughters with the same absolute PDG ID, is precomputed.
+ */
+class GenDecayTree {
+
+public:
+    GenDecayTree();
+    explicit GenDecayTree(const std::vector<reco::GenParticle>&);
+
+    const size_t size() const;
+    const std::vector<int>& pdgIds() const;
+    const std::vector<int>& charges() const;
+    const std::vector<uint16_t>& statusFlags() const;
+    const bool hasStatusFlag(const size_t&, const reco::GenStatusFlags::StatusBits&) const;
+    const GenIndexRange mothers(const size_t&) const;
+    const GenIndexRange daughters(const size_t&) const;
+    const uint32_t lastCopy(const size_t&) const;
+
+private:
+    std::vector<int> pdgIds_;
+    std::vector<int> charges_;
+    std::vector<uint16_t> statusFlags_;
+    std::vector<uint32_t> motherOffsets_;
+    std::vector<uint32_t> motherIndices_;
+    std::vector<uint32_t> daughterOffsets_;
+    std::vector<uint32_t> daughterIndices_;
+    std::vector<uint32_t> lastCopies_;
+}; // end class GenDecayTree
+
+
+}; // end namespace tautau_selection_gen
+
+#endif // end GUARD_GENDECAYTREE_H
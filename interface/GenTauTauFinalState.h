@@ -0,0 +1,37 @@
+#ifndef GUARD_GENTAUTAUFINALSTATE_H
+#define GUARD_GENTAUTAUFINALSTATE_H
+
+// user include files
+#include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
+
+
+namespace tautau_selection_gen {
+
+
+/*
+ * Generator-level classification of the dilepton pair of an event.
+ *
+ * The two decays belong to the leptons of the pair in the order in which the pair has been found, the decay mode of a
+ * hadronic tau decay follows the reconstruction convention 5 * (charged hadrons - 1) + neutral pions and is -1 for
+ * leptonic decays. Events without a pair hold the final state 'unknown' and empty decays.
+ */
+class GenTauTauFinalState {
+
+public:
+    GenTauTauFinalState();
+    GenTauTauFinalState(const HZGammaFinalState&, const GenTauDecay&, const GenTauDecay&);
+
+    const HZGammaFinalState finalState() const;
+    const GenTauDecay& firstTau() const;
+    const GenTauDecay& secondTau() const;
+
+private:
+    int finalState_;
+    GenTauDecay firstTau_;
+    GenTauDecay secondTau_;
+}; // end class GenTauTauFinalState
+
+
+}; // end namespace tautau_selection_gen
+
+#endif // end GUARD_GENTAUTAUFINALSTATE_H
@@ -0,0 +1,57 @@
+#ifndef GUARD_GENWEIGHTSUMMARY_H
+#define GUARD_GENWEIGHTSUMMARY_H
+
+// system include files
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * Sums of the generator weights of a set of events, e.g. a luminosity block or a run.
+ *
+ * The event count, the count of events with a negative weight, the sum of the weights and of their squares and,
+ * optionally, the sums of each LHE and parton shower weight are accumulated. All sums use compensated summation, so that
+ * they do not depend on the number of events beyond the precision of a double. All events of a summary have to carry
+ * the same number of LHE and parton shower weights, so that every variation sum covers the same events as the nominal
+ * sum; summaries are merged with add() under the same condition unless one of them holds no events. mergeProduct() lets the
+ * framework merge the luminosity block and run products of several jobs in the same way.
+ */
+class GenWeightSummary {
+
+public:
+    GenWeightSummary();
+
+    void fill(const double&, const vector<double>&, const vector<double>&);
+    void add(const GenWeightSummary&);
+    bool mergeProduct(const GenWeightSummary&);
+    void clear();
+
+    const uint64_t nEvents() const;
+    const uint64_t nNegativeWeights() const;
+    const double sumWeights() const;
+    const double sumWeights2() const;
+    const vector<double> lheSumWeights() const;
+    const vector<double> psSumWeights() const;
+
+private:
+    void checkWeightCount(const string&, const vector<double>&, const vector<double>&) const;
+    static void addWeights(vector<double>&, vector<double>&, const vector<double>&, const vector<double>&);
+    static const vector<double> getSums(const vector<double>&, const vector<double>&);
+
+    uint64_t nEvents_;
+    uint64_t nNegativeWeights_;
+    double sumWeights_;
+    double sumWeightsCompensation_;
+    double sumWeights2_;
+    double sumWeights2Compensation_;
+    vector<double> lheSumWeights_;
+    vector<double> lheSumWeightsCompensation_;
+    vector<double> psSumWeights_;
+    vector<double> psSumWeightsCompensation_;
+}; // end class GenWeightSummary
+
+
+#endif // end GUARD_GENWEIGHTSUMMARY_H
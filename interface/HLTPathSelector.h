@@ -0,0 +1,46 @@
+#ifndef GUARD_HLTPATHSELECTOR_H
+#define GUARD_HLTPATHSELECTOR_H
+
+// system include files
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * Matcher for the names of HLT paths against a list of selections, which is compiled once.
+ *
+ * A selection is compared to the name of a path without its version suffix '_v<N>', paths without a version suffix are
+ * never selected. Selections may contain the wildcards '*' (any sequence of characters) and '?' (any single character).
+ *
+ * All selections are stored in a prefix trie over their literal prefix, i.e. the part before the first wildcard. A path
+ * name is walked through the trie once; exact selections match if the walk ends on a terminal node, the remainder of a
+ * selection with wildcards is only tested at the nodes of its literal prefix.
+ */
+class HLTPathSelector {
+
+public:
+    HLTPathSelector();
+    HLTPathSelector(const vector<string>&);
+
+    const bool isSelected(const string&) const;
+
+private:
+    struct TrieNode {
+        vector<pair<char, size_t>> children;
+        vector<size_t> globs;
+        bool terminal;
+    };
+
+    const size_t addNode();
+    const size_t findChild(const size_t&, const char&) const;
+    static const bool matchGlob(const char*, const char*, const char*, const char*);
+
+    vector<TrieNode> nodes_;
+    vector<string> globSuffixes_;
+}; // end class HLTPathSelector
+
+
+#endif // end GUARD_HLTPATHSELECTOR_H
@@ -1,8 +1,9 @@
 #ifndef GUARD_HIGHLEVELTRIGGERPATH_H
 #define GUARD_HIGHLEVELTRIGGERPATH_H
 
-#include <regex>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace std;
@@ -12,17 +13,21 @@ class HighLevelTriggerPath {
 public:
     HighLevelTriggerPath();
     HighLevelTriggerPath(const string&, const int&, const vector<string>&, const vector<string>&);
-    const string& fullName();
-    const string& name();
-    const string& version();
-    const int& index();
-    const vector<string>& modules();
-    const vector<string>& modulesSaveTags();
-    const bool isInModulesSaveTags(const string&);
-    const int moduleIndex(const string&);
+    const string& fullName() const;
+    const string& name() const;
+    const string& version() const;
+    const int& index() const;
+    const vector<string>& modules() const;
+    const vector<string>& modulesSaveTags() const;
+    const bool isInModulesSaveTags(const string&) const;
+    const int moduleIndex(const string&) const;
+    const vector<int>& moduleIndicesSaveTags() const;
+    const uint64_t saveTagsMask(const int&, const bool&) const;
+
+    static const size_t versionPosition(const string&);
 
 private:
-    const pair<string, string> splitName(const string&);
+    static const pair<string, string> splitName(const string&);
 
     string fullName_;
     string name_;
@@ -30,8 +35,7 @@ private:
     int index_;
     vector<string> modules_;
     vector<string> modulesSaveTags_;
-
-    const regex nameRegex_ = regex("^(\\.+)_(v\\d+)$");
+    vector<int> moduleIndicesSaveTags_;
 };
 
 #endif // GUARD_HIGHLEVELTRIGGERPATH_H
\ No newline at end of file
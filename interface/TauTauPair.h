@@ -0,0 +1,81 @@
+#ifndef GUARD_TAUTAUPAIR_H
+#define GUARD_TAUTAUPAIR_H
+
+// system include files
+#include <cstdint>
+
+// user include files
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Common/interface/Ptr.h"
+
+
+namespace tautau_selection_reco {
+
+
+enum TauTauFinalState {
+    et,
+    mt,
+    tt,
+    ee,
+    mm,
+    em,
+    unknown
+};
+
+
+struct SortScore {
+    double isoScore;
+    double ptScore;
+};
+
+
+// working points of the DeepTau discriminators that are used in the preselection and the selection of the tau legs
+enum TauIDBit {
+    byVVLooseDeepTau2017v2p1VSe = 0,
+    byTightDeepTau2017v2p1VSe = 1,
+    byVLooseDeepTau2017v2p1VSmu = 2,
+    byTightDeepTau2017v2p1VSmu = 3,
+    byTightDeepTau2017v2p1VSjet = 4,
+    byMediumDeepTau2017v2p1VSjet = 5
+};
+
+
+/*
+ * Selected tau tau pair of an event.
+ *
+ * The legs point into the collections the pair has been selected from, the first leg is the electron or muon in the
+ * semi-leptonic final states. The sort scores are the ones the pair has been ranked with, the ID bits hold the tau ID
+ * working points (see TauIDBit) that a tau leg passes and are 0 for electrons and muons. Events without a pair hold a
+ * pair with final state 'unknown' and null legs.
+ */
+class TauTauPair {
+
+public:
+    TauTauPair();
+    TauTauPair(const TauTauFinalState&, const edm::Ptr<reco::Candidate>&, const edm::Ptr<reco::Candidate>&, const SortScore&, const SortScore&, const uint32_t&, const uint32_t&);
+
+    const TauTauFinalState finalState() const;
+    const bool isValid() const;
+    const edm::Ptr<reco::Candidate>& first() const;
+    const edm::Ptr<reco::Candidate>& second() const;
+    const SortScore firstSortScore() const;
+    const SortScore secondSortScore() const;
+    const uint32_t firstIDBits() const;
+    const uint32_t secondIDBits() const;
+
+private:
+    int finalState_;
+    edm::Ptr<reco::Candidate> first_;
+    edm::Ptr<reco::Candidate> second_;
+    double firstIsoScore_;
+    double firstPtScore_;
+    double secondIsoScore_;
+    double secondPtScore_;
+    uint32_t firstIDBits_;
+    uint32_t secondIDBits_;
+}; // end class TauTauPair
+
+
+}; // end namespace tautau_selection_reco
+
+#endif // end GUARD_TAUTAUPAIR_H
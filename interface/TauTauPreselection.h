@@ -0,0 +1,29 @@
+#ifndef GUARD_TAUTAUPRESELECTION_H
+#define GUARD_TAUTAUPRESELECTION_H
+
+// system include files
+#include <cstdint>
+#include <vector>
+
+
+namespace tautau_selection_reco {
+
+
+/*
+ * Objects of an event that pass the preselection of the tau tau pair selection.
+ *
+ * The lists hold indices into the electron, muon and tau collections the preselection has been run on, in the order of
+ * the collections. The veto lists are the looser selections that define the lepton vetoes of the final states.
+ */
+struct TauTauPreselection {
+    std::vector<uint32_t> electrons;
+    std::vector<uint32_t> vetoElectrons;
+    std::vector<uint32_t> muons;
+    std::vector<uint32_t> vetoMuons;
+    std::vector<uint32_t> taus;
+};
+
+
+}; // end namespace tautau_selection_reco
+
+#endif // end GUARD_TAUTAUPRESELECTION_H
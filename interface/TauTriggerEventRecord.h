@@ -0,0 +1,139 @@
+#ifndef GUARD_TAUTRIGGEREVENTRECORD_H
+#define GUARD_TAUTRIGGEREVENTRECORD_H
+
+// system include files
+#include <string>
+#include <tuple>
+#include <vector>
+
+// user include files
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/CandidateBranchSet.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeBranchBinder.h"
+
+using namespace std;
+
+
+// kinematic columns of the candidate collections, eta, phi and mass can be stored with a reduced mantissa
+template <typename T>
+using KinematicBranchSet = CandidateBranchSet<
+    T,
+    candidate_fields::Pt,
+    candidate_fields::Reducible<candidate_fields::Eta, 12>,
+    candidate_fields::Reducible<candidate_fields::Phi, 12>,
+    candidate_fields::Reducible<candidate_fields::Mass, 10>,
+    candidate_fields::Charge,
+    candidate_fields::PdgId
+>;
+
+
+// scalar columns of the decay of one generator-level pair lepton, the visible and neutrino kinematics can be rounded to
+// the same reduced mantissas as the candidate collections
+struct GenTauDecayBranchSet {
+    GenTauDecayBranchSet(const string&);
+
+    void branch(TreeBranchBinder&);
+    void clear();
+    void fill(const tautau_selection_gen::GenTauDecay&);
+    void reducePrecision();
+
+    string prefix;
+    int finalState;
+    int decayMode;
+    float visPt;
+    float visEta;
+    float visPhi;
+    float visMass;
+    float nuPt;
+    float nuEta;
+    float nuPhi;
+    float nuMass;
+}; // end struct GenTauDecayBranchSet
+
+
+// column buffers of one row of the 'Events' tree
+struct TauTriggerEventRecord {
+    TauTriggerEventRecord();
+
+    void branch(TreeBranchBinder&);
+    void clear();
+    void reducePrecision();
+    const tuple<long int, long int, long int> sortKey() const;
+
+    long int lumi;
+    long int run;
+    long int event;
+    bool isElTau;
+    bool isMuTau;
+    bool isTauTau;
+    float genWeight;
+    int genFinalState;
+    GenTauDecayBranchSet genTau1;
+    GenTauDecayBranchSet genTau2;
+    int hltMenuId;
+    KinematicBranchSet<reco::GenParticle> genParticles;
+    KinematicBranchSet<reco::Candidate> pairElectrons;
+    KinematicBranchSet<reco::Candidate> pairMuons;
+    KinematicBranchSet<reco::Candidate> pairTaus;
+    KinematicBranchSet<pat::TriggerObjectStandAlone> triggerObjects;
+    vector<int> pairElectronTriggerObjectIndex;
+    vector<int> pairMuonTriggerObjectIndex;
+    vector<int> pairTauTriggerObjectIndex;
+    vector<int> triggerAssocObjectIndex;
+    vector<int> triggerAssocHLTPathIndex;
+    vector<int> triggerAssocModuleIndex;
+    vector<int> triggerAssocType;
+    vector<int> triggerObjectPathObjectIndex;
+    vector<int> triggerObjectPathHLTPathIndex;
+    vector<ULong64_t> triggerObjectPathMask;
+    vector<int> hltPathLastModule;
+    vector<int> hltPathLastModuleState;
+    vector<ULong64_t> hltPathSaveTagsMask;
+    vector<int> pairLegPathLegType;
+    vector<int> pairLegPathLegIndex;
+    vector<int> pairLegPathHLTPathIndex;
+    vector<int> pairLegPathDeepestModule;
+    vector<ULong64_t> pairLegPathMask;
+}; // end struct TauTriggerEventRecord
+
+
+// column buffers of one row of the 'HLT' tree, one row per selected path of each distinct HLT menu
+// the path columns of the 'Events' tree follow the order of the path slots of the menu of the event
+struct TauTriggerHLTRecord {
+    TauTriggerHLTRecord();
+
+    void branch(TreeBranchBinder&);
+    void clear();
+    const tuple<long int, long int, long int> sortKey() const;
+
+    int hltMenuId;
+    string hltTableName;
+    string hltGlobalTag;
+    string hltProcessPSetHash;
+    int hltPathSlot;
+    string hltPathName;
+    string hltPathVersion;
+    int hltPathIndex;
+    vector<int> hltPathModuleLabelIds;
+    vector<int> hltPathSaveTagsLabelIds;
+}; // end struct TauTriggerHLTRecord
+
+
+// column buffers of one row of the 'HLTModuleLabels' tree, the string table of the module labels of the 'HLT' tree
+struct TauTriggerModuleLabelRecord {
+    TauTriggerModuleLabelRecord();
+
+    void branch(TreeBranchBinder&);
+    void clear();
+    const tuple<long int, long int, long int> sortKey() const;
+
+    int hltModuleLabelId;
+    string hltModuleLabel;
+}; // end struct TauTriggerModuleLabelRecord
+
+
+#endif // end GUARD_TAUTRIGGEREVENTRECORD_H
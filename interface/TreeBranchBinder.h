@@ -0,0 +1,114 @@
+#ifndef GUARD_TREEBRANCHBINDER_H
+#define GUARD_TREEBRANCHBINDER_H
+
+// system include files
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// user include files
+#include <TBranch.h>
+#include <TTree.h>
+
+using namespace std;
+
+
+enum TreeLayout {
+    vectorBranches,
+    flatArrays
+};
+
+
+const TreeLayout getTreeLayout(const string&);
+
+
+/*
+ * Registers the columns of a record as branches of a tree in one of two layouts:
+ *   - vectorBranches: every jagged column is a std::vector branch
+ *   - flatArrays: the columns of a collection share a counter leaf 'n<Collection>' and every column is a plain array
+ *     leaf of that length, i.e. an offset/value layout that columnar readers can load without deserializing vectors
+ *
+ * With flat arrays the addresses of the array leaves follow the buffers of the vectors, prepare() has to be called
+ * before each fill of the tree. All columns of a collection must have the same length.
+ */
+class TreeBranchBinder {
+
+public:
+    TreeBranchBinder();
+    TreeBranchBinder(TTree*, const TreeLayout&);
+
+    template <typename T> void addScalar(const string&, T*, const string&);
+    template <typename T> void addObject(const string&, T*);
+    template <typename T> void addColumn(const string&, const string&, vector<T>*);
+    void prepare();
+
+private:
+    struct FlatGroup {
+        string name;
+        unique_ptr<Int_t> counter;
+        size_t firstColumn;
+    };
+
+    struct FlatColumn {
+        size_t group;
+        TBranch* branch;
+        function<size_t()> size;
+        function<void*()> data;
+    };
+
+    template <typename T> static const char leafType();
+    const size_t getGroup(const string&);
+
+    TTree* tree_;
+    TreeLayout layout_;
+    vector<FlatGroup> groups_;
+    vector<FlatColumn> columns_;
+}; // end class TreeBranchBinder
+
+
+// leaf type codes of the supported column types
+template <> inline const char TreeBranchBinder::leafType<float>() { return 'F'; }
+template <> inline const char TreeBranchBinder::leafType<double>() { return 'D'; }
+template <> inline const char TreeBranchBinder::leafType<int>() { return 'I'; }
+template <> inline const char TreeBranchBinder::leafType<unsigned int>() { return 'i'; }
+template <> inline const char TreeBranchBinder::leafType<Long64_t>() { return 'L'; }
+template <> inline const char TreeBranchBinder::leafType<ULong64_t>() { return 'l'; }
+
+
+template <typename T>
+void TreeBranchBinder::addScalar(const string& name, T* address, const string& leaflist) {
+    tree_->Branch(name.c_str(), address, leaflist.c_str());
+}
+
+
+template <typename T>
+void TreeBranchBinder::addObject(const string& name, T* address) {
+    tree_->Branch(name.c_str(), address);
+}
+
+
+template <typename T>
+void TreeBranchBinder::addColumn(const string& group, const string& name, vector<T>* column) {
+    if (layout_ == TreeLayout::vectorBranches) {
+        tree_->Branch(name.c_str(), column);
+        return;
+    }
+
+    const size_t groupIndex = getGroup(group);
+    const string leaflist = name + "[" + groups_.at(groupIndex).name + "]/" + leafType<T>();
+
+    // the address is replaced in prepare(), the dummy only keeps ROOT from allocating its own buffer
+    static T dummy = T();
+    TBranch* branch = tree_->Branch(name.c_str(), &dummy, leaflist.c_str());
+    columns_.push_back(FlatColumn{
+        groupIndex,
+        branch,
+        [column] () { return column->size(); },
+        [column] () { return column->empty() ? static_cast<void*>(&dummy) : static_cast<void*>(column->data()); }
+    });
+}
+
+
+#endif // end GUARD_TREEBRANCHBINDER_H
@@ -0,0 +1,54 @@
+#ifndef GUARD_TREEWRITEPROFILE_H
+#define GUARD_TREEWRITEPROFILE_H
+
+// system include files
+#include <string>
+#include <vector>
+
+// user include files
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <TTree.h>
+
+using namespace std;
+
+
+// compression and basket size for all branches whose name matches a wildcard pattern
+struct BranchWriteSettings {
+    string pattern;
+    int compressionSettings;
+    int basketSize;
+};
+
+
+/*
+ * Compression, basket size and auto-flush policy of an output tree.
+ *
+ * A profile is selected by name and can be refined by explicit settings:
+ *   - "default": the settings of the output file and the ROOT defaults are kept
+ *   - "fastWrite": LZ4 compression, large baskets and a coarse auto-flush, for jobs in which writing is CPU-bound
+ *   - "archive": strong LZMA (or ZSTD, if available) compression and moderately sized clusters for long-term storage
+ *
+ * A compression level or basket size of -1 and an auto-flush of 0 keep the value of the selected profile.
+ */
+class TreeWriteProfile {
+
+public:
+    TreeWriteProfile();
+    TreeWriteProfile(const edm::ParameterSet&);
+
+    void apply(TTree*) const;
+    const string report(TTree*) const;
+
+private:
+    static const int getCompressionSettings(const string&, const int&);
+
+    string name_;
+    int compressionSettings_;
+    int basketSize_;
+    Long64_t autoFlush_;
+    vector<BranchWriteSettings> branchSettings_;
+}; // end class TreeWriteProfile
+
+
+#endif // end GUARD_TREEWRITEPROFILE_H
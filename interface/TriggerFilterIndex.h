@@ -0,0 +1,48 @@
+#ifndef GUARD_TRIGGERFILTERINDEX_H
+#define GUARD_TRIGGERFILTERINDEX_H
+
+// system include files
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// user include files
+#include "TauAnalysis/TauTriggerNtuples/interface/HighLevelTriggerPath.h"
+
+using namespace std;
+
+
+// position of a saveTags filter within the selected HLT paths
+struct TriggerFilterEntry {
+    size_t pathSlot;
+    int hltPathIndex;
+    int moduleIndex;
+    size_t saveTagsIndex;
+};
+
+
+/*
+ * Lookup from the label of a saveTags filter to all selected HLT paths that contain this filter.
+ *
+ * The entries of all labels are stored in one flat vector, the hash map only holds the range of entries that belong to a
+ * label. The path slot is the position of the path in the list the index has been built from, the saveTags index is
+ * the position of the filter within the saveTags filters of the path.
+ */
+class TriggerFilterIndex {
+
+public:
+    TriggerFilterIndex();
+    TriggerFilterIndex(const vector<shared_ptr<HighLevelTriggerPath>>&);
+
+    const pair<const TriggerFilterEntry*, const TriggerFilterEntry*> find(const string&) const;
+    const size_t size() const;
+
+private:
+    unordered_map<string, pair<size_t, size_t>> ranges_;
+    vector<TriggerFilterEntry> entries_;
+}; // end class TriggerFilterIndex
+
+
+#endif // end GUARD_TRIGGERFILTERINDEX_H
@@ -0,0 +1,49 @@
+#ifndef GUARD_TRIGGEROBJECTMATCHER_H
+#define GUARD_TRIGGEROBJECTMATCHER_H
+
+// system include files
+#include <vector>
+
+using namespace std;
+
+
+/*
+ * Delta R matching of offline objects to the trigger objects of an event.
+ *
+ * The trigger objects are bucketed into an eta-phi grid whose cells are at least as large as the matching cone, so a
+ * query only has to visit the cell of the offline object and its eight neighbours. Objects beyond the eta range of the
+ * grid are put into the outermost cells. Objects are added with add() and identified by the order in which they have been
+ * added; build() has to be called once after all objects of the event have been added and before the first query.
+ */
+class TriggerObjectMatcher {
+
+public:
+    TriggerObjectMatcher();
+    TriggerObjectMatcher(const double&);
+
+    void clear();
+    const size_t add(const double&, const double&);
+    void build();
+    void match(const double&, const double&, vector<size_t>&) const;
+    const double deltaR2(const size_t&, const double&, const double&) const;
+    const size_t size() const;
+
+private:
+    const size_t etaCell(const double&) const;
+    const size_t phiCell(const double&) const;
+
+    double maxDeltaR2_;
+    double etaMax_;
+    double etaCellSize_;
+    double phiCellSize_;
+    size_t nEtaCells_;
+    size_t nPhiCells_;
+    vector<double> etas_;
+    vector<double> phis_;
+    vector<size_t> cells_;
+    vector<size_t> cellOffsets_;
+    vector<size_t> cellObjects_;
+}; // end class TriggerObjectMatcher
+
+
+#endif // end GUARD_TRIGGEROBJECTMATCHER_H
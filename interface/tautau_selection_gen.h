@@ -2,10 +2,14 @@
 #define GUARD_TAUTAU_SELECTION_GEN_H
 
 // system include files
+#include <cstdint>
 #include <vector>
 
 // user include files
 #include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+#include "DataFormats/Math/interface/LorentzVector.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
 
 using namespace reco;
 using namespace std;
@@ -27,6 +31,15 @@ enum HZGammaFinalState {
 };
 
 
+// outcome of the search for the lepton pair of the hard process
+enum DileptonSearchStatus {
+    pairFound,
+    missingLeptons,
+    tooManyLeptons,
+    sameSignLeptons
+};
+
+
 enum TauFinalState {
     tauToE,
     tauToM,
@@ -35,25 +48,95 @@ enum TauFinalState {
 };
 
 
+/*
+ * Decay of one lepton of a generator-level dilepton pair.
+ *
+ * For taus, the visible four-momentum is the sum over the direct daughters of the last copy apart from the neutrinos,
+ * whose sum is the neutrino four-momentum. Prompt electrons and muons are their own visible part after radiation, their
+ * final state is tauToUnknown and their decay mode -1.
+ */
+struct GenTauDecay {
+    int finalState;
+    int decayMode;
+    math::XYZTLorentzVector visibleP4;
+    math::XYZTLorentzVector neutrinoP4;
+};
+
+
+/*
+ * The functions work on pointers and references into the generator record of the event, e.g. prunedGenParticles, and
+ * do not copy particles; copies are only made by the modules that write particles to the event. Every function also
+ * has an overload that takes the GenDecayTree of the record and identifies particles by their index in the record.
+ */
 const GenParticle& getHZGammaBoson(const vector<GenParticle>&);
 
 
-const bool setPairLeptons(const vector<GenParticle>&, const int&, GenParticle&, GenParticle&); 
+const uint32_t getHZGammaBoson(const GenDecayTree&);
+
+
+/*
+ * Hard-process first-copy electrons, muons and taus are sorted into one pair of slots per flavour in a single pass over
+ * the record. The first flavour in the order e, mu, tau with exactly two leptons of opposite charge sets the pair. If no
+ * flavour does, the status reports the first flavour with more than two or with two same-sign leptons, otherwise that
+ * leptons are missing.
+ */
+const DileptonSearchStatus findPairLeptons(const vector<GenParticle>&, const GenParticle*&, const GenParticle*&);
 
 
-const pair<GenParticle, GenParticle> getHZGammaLeptonPair(const GenParticle&, const int&);
+const DileptonSearchStatus findPairLeptons(const GenDecayTree&, uint32_t&, uint32_t&);
+
+
+const pair<const GenParticle*, const GenParticle*> getHZGammaLeptonPair(const GenParticle&, const int&);
+
+
+const pair<uint32_t, uint32_t> getHZGammaLeptonPair(const GenDecayTree&, const uint32_t&, const int&);
 
 
 const TauFinalState getTauFinalState(const GenParticle&);
 
 
+const TauFinalState getTauFinalState(const GenDecayTree&, const uint32_t&);
+
+
+// decay mode of a tau in the reconstruction convention, -1 for leptonic decays
+const int getTauDecayMode(const GenParticle&);
+
+
+const int getTauDecayMode(const GenDecayTree&, const uint32_t&);
+
+
+// final state, decay mode and visible and neutrino four-momenta of a lepton of the pair from a single pass over its daughters
+const GenTauDecay getLeptonDecay(const GenParticle&);
+
+
+const GenTauDecay getLeptonDecay(const GenDecayTree&, const vector<GenParticle>&, const uint32_t&);
+
+
+// final state of a tau pair from the final states of its two taus, independent of their order
+const HZGammaFinalState getTauPairFinalState(const TauFinalState&, const TauFinalState&);
+
+
 const HZGammaFinalState getDileptonFinalState(const GenParticle&, const GenParticle&);
 
 
+const HZGammaFinalState getDileptonFinalState(const GenDecayTree&, const uint32_t&, const uint32_t&);
+
+
 const HZGammaFinalState getHZGammaFinalState(const GenParticle&);
 
 
-const vector<GenParticle> getDirectDaughters(const GenParticle&);
+const HZGammaFinalState getHZGammaFinalState(const GenDecayTree&, const uint32_t&);
+
+
+// last copy of a particle, found by following the daughters with the same absolute PDG ID
+const GenParticle& getLastCopy(const GenParticle&);
+
+
+// daughters of the last copy of a particle as references into the generator record or as indices
+const GenParticleRefVector& getDirectDaughters(const GenParticle&);
+
+
+const GenIndexRange getDirectDaughters(const GenDecayTree&, const uint32_t&);
 
 
 }; // end namespace tautau_selection_gen
@@ -2,15 +2,20 @@
 #define GUARD_TAUTAU_SELECTION_RECO_H
 
 // system include files
+#include <cstdint>
+#include <string>
 #include <vector>
 
 // user include files
 #include "DataFormats/PatCandidates/interface/Electron.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "DataFormats/PatCandidates/interface/Tau.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
 
 #include "Math/Vector4D.h"
 
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPair.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPreselection.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/util.h"
 
 using namespace pat;
@@ -21,53 +26,139 @@ using namespace std;
 namespace tautau_selection_reco {
 
 
-enum TauTauFinalState {
-    et,
-    mt,
-    tt,
-    ee,
-    mm,
-    em,
-    unknown
+/*
+ * Sort key of a pair leg, a larger key ranks the leg higher.
+ *
+ * The iso and pt scores are rounded to 17 mantissa bits, which corresponds to the relative tolerance of 1e-5 that the
+ * scores used to be compared with, and packed into the upper and lower 32 bits in an order preserving way. Pairs are
+ * ranked by the key of the first leg and then by the key of the second leg, which is a strict weak ordering and does not
+ * depend on the compiler or the order of the candidates.
+ */
+const uint64_t getSortKey(const SortScore&);
+
+
+/*
+ * Positions of the tau ID discriminators of the selection in the ID list of the taus.
+ *
+ * pat::Tau::tauID() searches the list by name on each call. All taus of a collection share the layout of the list, so
+ * the positions are resolved once and only verified with update() for each new collection; they are resolved again if
+ * the layout has changed.
+ */
+class TauIDResolver {
+
+public:
+    TauIDResolver();
+
+    void update(const Tau&);
+    const uint32_t getIDBits(const Tau&) const;
+    const float getDeepTauVSjetRaw(const Tau&) const;
+
+private:
+    static const vector<string>& getNames();
+
+    vector<size_t> indices_;
+}; // end class TauIDResolver
+
+
+// cuts of the signal and the veto selection of electrons or muons, the isolation is relative to the pt
+struct LeptonCuts {
+    double ptMin;
+    double vetoPtMin;
+    double etaMax;
+    double dxyMax;
+    double dzMax;
+    double relIsoMax;
+    double vetoRelIsoMax;
 };
 
 
-struct SortScore {
+/*
+ * Preselection of the electrons, muons and taus for the tau tau pair selection.
+ *
+ * Every collection is run over once, the quantities shared by the signal and the veto selection are computed once per
+ * object. The thresholds are read from the electronSelection, muonSelection and tauSelection PSets, the working points
+ * of the tau IDs are fixed to VVLoose vs. electrons, VLoose vs. muons and Medium vs. jets.
+ */
+class TauTauPreselector {
+
+public:
+    TauTauPreselector(const edm::ParameterSet&);
+
+    void select(const vector<Electron>&, const vector<Muon>&, const vector<Tau>&, const TauIDResolver&, TauTauPreselection&) const;
+
+private:
+    static const LeptonCuts getLeptonCuts(const edm::ParameterSet&);
+
+    LeptonCuts electronCuts_;
+    string electronID_;
+    LeptonCuts muonCuts_;
+    double tauPtMin_;
+    double tauEtaMax_;
+    vector<int> tauDecayModes_;
+}; // end class TauTauPreselector
+
+
+// quantities of a pair leg candidate that enter the selection, the iso score is the one the pairs are sorted with
+struct PairLegFeatures {
+    uint32_t index;
+    uint32_t idBits;
     double isoScore;
-    double ptScore;
+    double pt;
+    float dz;
+    int charge;
+    uint64_t sortKey;
 };
 
 
-const bool comparePairs(const pair<SortScore, SortScore>&,  const pair<SortScore, SortScore>&);
+// buffers of the pair selection, the tau kinematics belong to the preselected taus, kept by the caller across events so that their memory is reused
+struct TauTauPairWorkspace {
+    vector<PairLegFeatures> electronFeatures;
+    vector<PairLegFeatures> muonFeatures;
+    vector<PairLegFeatures> tauFeatures;
+    util::KinematicsSoA tauKinematics;
+    vector<float> deltaR2;
+};
 
 
+/*
+ * Selection of the tau tau pair of an event from preselected electrons, muons and taus.
+ *
+ * The algorithm only keeps references to the input collections, the preselection, the tau ID resolver and the
+ * workspace, which have to outlive it; only the preselected objects of the collections are considered. The quantities of the candidates that enter the selection are computed once per object, the vetoes are
+ * checked before any pair is built and the best pair of a final state is kept in a single scan over the candidates. The
+ * selected pair is reported as indices into the input collections; the pair getters return references to the selected
+ * objects, copies are only made by callers that need them.
+ */
 class TauTauPairAlgorithm {
 
 public:
-    TauTauPairAlgorithm(const vector<Electron>&, const vector<Muon>&, const vector<Tau>&, const vector<Electron>&, const vector<Muon>&);
+    TauTauPairAlgorithm(const vector<Electron>&, const vector<Muon>&, const vector<Tau>&, const TauTauPreselection&, const TauIDResolver&, TauTauPairWorkspace&);
 
     void execute();
     const TauTauFinalState getFinalState() const;
-    const pair<Electron, Tau> getPairET() const;
-    const pair<Muon, Tau> getPairMT() const;
-    const pair<Tau, Tau> getPairTT() const;
+    const pair<size_t, size_t> getPairIndices() const;
+    const pair<SortScore, SortScore> getPairSortScores() const;
+    const pair<const Electron&, const Tau&> getPairET() const;
+    const pair<const Muon&, const Tau&> getPairMT() const;
+    const pair<const Tau&, const Tau&> getPairTT() const;
 
 private:
     const bool findPairET();
     const bool findPairMT();
     const bool findPairTT();
+    void computeFeatures();
 
-    vector<Electron> electrons_;
-    vector<Muon> muons_;
-    vector<Tau> taus_;
-    vector<Electron> vetoElectrons_;
-    vector<Muon> vetoMuons_;
+    const vector<Electron>& electrons_;
+    const vector<Muon>& muons_;
+    const vector<Tau>& taus_;
+    const TauTauPreselection& preselection_;
+    const TauIDResolver& tauIDResolver_;
+    TauTauPairWorkspace& workspace_;
 
     bool hasBeenExecuted_;
     TauTauFinalState finalState_;
-    pair<Electron, Tau> etPair_;
-    pair<Muon, Tau> mtPair_;
-    pair<Tau, Tau> ttPair_;
+    pair<size_t, size_t> pairIndices_;
+    pair<SortScore, SortScore> pairSortScores_;
 }; // end class TauTauPairAlgorithm
 
 
@@ -1,6 +1,11 @@
 #ifndef GUARD_UTIL_H
 #define GUARD_UTIL_H
 
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
 #include "Math/Vector4D.h"
 
 using namespace ROOT::Math;
@@ -18,6 +23,117 @@ const bool approxEqual(const double&, const double&, const double&);
 const double getDeltaR(const LorentzVector<PxPyPzE4D<double>>&, const LorentzVector<PxPyPzE4D<double>>&);
 
 
+/*
+ * Kinematics of a collection as structure of arrays, so that the batch functions below run over contiguous floats.
+ *
+ * The phi values are expected in [-pi, pi], as returned by the candidates.
+ */
+struct KinematicsSoA {
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<float> mass;
+
+    void clear();
+    void reserve(const size_t&);
+    const size_t size() const;
+    template <typename T> void push_back(const T&);
+    template <typename Collection> void fill(const Collection&);
+};
+
+
+// scalar kinematics, delta phi is wrapped into [-pi, pi]
+const float deltaPhi(const float&, const float&);
+
+
+const float deltaR2(const float&, const float&, const float&, const float&);
+
+
+// double precision variants for callers that work on full-precision four-vectors
+const double deltaPhi(const double&, const double&);
+
+
+const double deltaR2(const double&, const double&, const double&, const double&);
+
+
+const float invariantMass(const float&, const float&, const float&, const float&, const float&, const float&, const float&, const float&);
+
+
+const float transverseMass(const float&, const float&, const float&, const float&);
+
+
+// one-vs-many batch kinematics, the result i belongs to object i of the collection, the output is resized
+void deltaR2(const float&, const float&, const KinematicsSoA&, std::vector<float>&);
+
+
+void invariantMass(const float&, const float&, const float&, const float&, const KinematicsSoA&, std::vector<float>&);
+
+
+void transverseMass(const float&, const float&, const KinematicsSoA&, std::vector<float>&);
+
+
+// many-vs-many batch kinematics, the result i * n2 + j belongs to object i of the first and object j of the second collection
+void deltaR2(const KinematicsSoA&, const KinematicsSoA&, std::vector<float>&);
+
+
+void invariantMass(const KinematicsSoA&, const KinematicsSoA&, std::vector<float>&);
+
+
+void transverseMass(const KinematicsSoA&, const KinematicsSoA&, std::vector<float>&);
+
+
+template <typename T>
+void KinematicsSoA::push_back(const T& candidate) {
+    pt.push_back(candidate.pt());
+    eta.push_back(candidate.eta());
+    phi.push_back(candidate.phi());
+    mass.push_back(candidate.mass());
+}
+
+
+template <typename Collection>
+void KinematicsSoA::fill(const Collection& candidates) {
+    clear();
+    reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        push_back(candidate);
+    }
+}
+
+
+// round the mantissa of a float to the given number of bits, the exponent is not changed apart from a carry
+template <int bits>
+inline float reduceMantissa(const float& value) {
+    static_assert((bits > 0) && (bits <= 23), "the mantissa of a float has 23 bits");
+    if constexpr (bits == 23) {
+        return value;
+    } else {
+        constexpr uint32_t shift = 23 - bits;
+        constexpr uint32_t mask = ~((uint32_t(1) << shift) - 1);
+        constexpr uint32_t half = uint32_t(1) << (shift - 1);
+        uint32_t word;
+        std::memcpy(&word, &value, sizeof(word));
+        // keep infinities and NaNs as they are
+        if ((word & 0x7F800000u) == 0x7F800000u) {
+            return value;
+        }
+        word = (word + half) & mask;
+        float reduced;
+        std::memcpy(&reduced, &word, sizeof(reduced));
+        return reduced;
+    }
+}
+
+
+// compensated (Kahan-Babuska) summation, the rounding error of each addition is collected in the compensation and the
+// sum is sum + compensation
+void compensatedAdd(double&, double&, const double&);
+
+
+// process-wide mutex for all modules of this package that write to the output file of the TFileService
+std::mutex& getTFileServiceMutex();
+
+
 }; // end namespace util
 
 #endif // end GUARD_UTIL_H
\ No newline at end of file
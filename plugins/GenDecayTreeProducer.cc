@@ -0,0 +1,60 @@
+// system include files
+
+#include <memory>
+#include <vector>
+
+// user include files
+
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/Utilities/interface/EDGetToken.h"
+#include "FWCore/Utilities/interface/EDPutToken.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
+
+using namespace edm;
+using namespace std;
+using namespace reco;
+using namespace tautau_selection_gen;
+
+
+class GenDecayTreeProducer : public global::EDProducer<> {
+
+public:
+    explicit GenDecayTreeProducer(const ParameterSet&);
+    ~GenDecayTreeProducer();
+
+private:
+    void produce(StreamID, Event&, const EventSetup&) const override;
+
+    EDGetTokenT<vector<GenParticle>> genParticles_;
+
+    EDPutTokenT<GenDecayTree> genDecayTree_;
+};
+
+
+GenDecayTreeProducer::GenDecayTreeProducer(const ParameterSet& iConfig) {
+    genParticles_ = consumes<vector<GenParticle>>(iConfig.getParameter<InputTag>("genParticles"));
+    genDecayTree_ = produces<GenDecayTree>();
+}
+
+
+GenDecayTreeProducer::~GenDecayTreeProducer() {}
+
+
+void GenDecayTreeProducer::produce(StreamID streamID, Event& event, const EventSetup& setup) const {
+    Handle<vector<GenParticle>> genParticles;
+    event.getByToken(genParticles_, genParticles);
+
+    event.put(genDecayTree_, make_unique<GenDecayTree>(*genParticles));
+}
+
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(GenDecayTreeProducer);
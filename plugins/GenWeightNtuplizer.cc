@@ -1,42 +1,117 @@
 // system include files
 #include <memory>
 #include <cmath>
+#include <mutex>
 #include <regex>
+#include <vector>
 
 
 // user include files
 
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 
-#include "DataFormats/Common/interface/TriggerResults.h"
-#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
-#include "DataFormats/PatCandidates/interface/Electron.h"
-#include "DataFormats/PatCandidates/interface/Muon.h"
-#include "DataFormats/PatCandidates/interface/Tau.h"
-#include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
-
 #include "FWCore/Framework/interface/Frameworkfwd.h"
-#include "FWCore/Framework/interface/one/EDAnalyzer.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
 #include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/Framework/interface/Run.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
-#include "HLTrigger/HLTcore/interface/HLTConfigProvider.h"
-
 #include "SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h"
+#include "SimDataFormats/GeneratorProducts/interface/LHEEventProduct.h"
 
-#include "TauAnalysis/TauTriggerNtuples/interface/HighLevelTriggerPath.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenWeightSummary.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeWriteProfile.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
 
 #include <TTree.h>
 
 using namespace edm;
-using namespace pat;
 using namespace std;
 
 
-class GenWeightNtuplizer: public one::EDAnalyzer<one::SharedResources> {
+// column buffers of one row of the 'genWeightLumis' or 'genWeightRuns' tree, the latter has no lumi column
+struct GenWeightSummaryRecord {
+    void branch(TTree*, const bool&);
+    void fill(const long int&, const long int&, const GenWeightSummary&);
+
+    long int lumi;
+    long int run;
+    long int nEvents;
+    long int nNegativeWeights;
+    double sumWeights;
+    double sumWeights2;
+    vector<double> lheSumWeights;
+    vector<double> psSumWeights;
+};
+
+
+void GenWeightSummaryRecord::branch(TTree* tree, const bool& withLumi) {
+    if (withLumi) {
+        tree->Branch("lumi", &lumi, "lumi/L");
+    }
+    tree->Branch("run", &run, "run/L");
+    tree->Branch("nEvents", &nEvents, "nEvents/L");
+    tree->Branch("nNegativeWeights", &nNegativeWeights, "nNegativeWeights/L");
+    tree->Branch("sumWeights", &sumWeights, "sumWeights/D");
+    tree->Branch("sumWeights2", &sumWeights2, "sumWeights2/D");
+    tree->Branch("lheSumWeights", &lheSumWeights);
+    tree->Branch("psSumWeights", &psSumWeights);
+}
+
+
+void GenWeightSummaryRecord::fill(const long int& lumi, const long int& run, const GenWeightSummary& summary) {
+    this->lumi = lumi;
+    this->run = run;
+    nEvents = static_cast<long int>(summary.nEvents());
+    nNegativeWeights = static_cast<long int>(summary.nNegativeWeights());
+    sumWeights = summary.sumWeights();
+    sumWeights2 = summary.sumWeights2();
+    lheSumWeights = summary.lheSumWeights();
+    psSumWeights = summary.psSumWeights();
+}
+
+
+// weight sums of the luminosity block and of the run that a stream is processing, merged into the summaries of the
+// module at the end of each transition, and the buffers of the LHE and parton shower weights of the current event
+struct GenWeightStreamCache {
+    GenWeightSummary lumiSummary;
+    GenWeightSummary runSummary;
+    vector<double> lheEventWeights;
+    vector<double> psEventWeights;
+};
+
+
+/*
+ * Sums of the generator weights per luminosity block and per run, put as luminosity block and run products and written
+ * to the 'genWeightLumis' and 'genWeightRuns' trees, and optionally the weight of each event, written to the
+ * 'genWeights' tree.
+ *
+ * Each stream sums the weights of its events, the sums of the streams are merged by the framework at the end of each
+ * luminosity block and run, so that the module never serializes the event loop. The products merge across jobs with
+ * GenWeightSummary::mergeProduct(); they are only stored if an output module keeps them, see the genWeightSummaryFile
+ * option of TauTriggerNtuplizer_cfg.py, otherwise the trees are the only record of the summaries.
+ *
+ * The LHE weights are summed relative to the original LHE weight and the parton shower weights relative to the nominal
+ * weight of the GenEventInfoProduct, both times the generator weight, so that each sum normalizes its variation in the
+ * same way as sumWeights normalizes the nominal weight.
+ *
+ * As a global module it cannot declare the "TFileService" shared resource. The trees are written under
+ * util::getTFileServiceMutex(), which only the modules of this package take; legacy or one:: modules of other packages
+ * that write through the TFileService in the same job are not serialized against this module.
+ */
+class GenWeightNtuplizer: public global::EDProducer<
+    StreamCache<GenWeightStreamCache>,
+    RunSummaryCache<GenWeightSummary>,
+    LuminosityBlockSummaryCache<GenWeightSummary>,
+    EndRunProducer,
+    EndLuminosityBlockProducer
+> {
 
     public:
         explicit GenWeightNtuplizer(const ParameterSet&);
@@ -46,29 +121,67 @@ class GenWeightNtuplizer: public one::EDAnalyzer<one::SharedResources> {
     private:
         virtual void beginJob() override;
         virtual void endJob() override;
-        virtual void analyze(const Event&, const EventSetup&) override;
+        virtual unique_ptr<GenWeightStreamCache> beginStream(StreamID) const override;
+        virtual void streamBeginRun(StreamID, const Run&, const EventSetup&) const override;
+        virtual void streamBeginLuminosityBlock(StreamID, const LuminosityBlock&, const EventSetup&) const override;
+        virtual void produce(StreamID, Event&, const EventSetup&) const override;
+        virtual shared_ptr<GenWeightSummary> globalBeginRunSummary(const Run&, const EventSetup&) const override;
+        virtual void streamEndRunSummary(StreamID, const Run&, const EventSetup&, GenWeightSummary*) const override;
+        virtual void globalEndRunSummary(const Run&, const EventSetup&, GenWeightSummary*) const override;
+        virtual void globalEndRunProduce(Run&, const EventSetup&, const GenWeightSummary*) const override;
+        virtual shared_ptr<GenWeightSummary> globalBeginLuminosityBlockSummary(const LuminosityBlock&, const EventSetup&) const override;
+        virtual void streamEndLuminosityBlockSummary(StreamID, const LuminosityBlock&, const EventSetup&, GenWeightSummary*) const override;
+        virtual void globalEndLuminosityBlockSummary(const LuminosityBlock&, const EventSetup&, GenWeightSummary*) const override;
+        virtual void globalEndLuminosityBlockProduce(LuminosityBlock&, const EventSetup&, const GenWeightSummary*) const override;
 
         EDGetTokenT<GenEventInfoProduct> genEvtInfo_;
+        EDGetTokenT<LHEEventProduct> lheEventProduct_;
+        EDPutTokenT<GenWeightSummary> runSummary_;
+        EDPutTokenT<GenWeightSummary> lumiSummary_;
 
-        TTree* genWeightTree_;
-        long int lumi_;
-        long int run_;
-        long int event_;
-        float genWeight_;
+        bool writeEvents_;
+        bool lheWeights_;
+        bool psWeights_;
+
+        TreeWriteProfile writeProfile_;
 
         Service<TFileService> fs_;
+
+        // thread-safe: the trees and their row buffers are only accessed under the mutex of the output file
+        TTree* genWeightTree_;
+        mutable long int lumi_;
+        mutable long int run_;
+        mutable long int event_;
+        mutable float genWeight_;
+
+        TTree* genWeightLumisTree_;
+        TTree* genWeightRunsTree_;
+        mutable GenWeightSummaryRecord summaryRecord_;
 };
 
 
 GenWeightNtuplizer::GenWeightNtuplizer(const ParameterSet& iConfig) {
     genEvtInfo_ = consumes<GenEventInfoProduct>(iConfig.getParameter<InputTag>("generator"));
+    runSummary_ = produces<GenWeightSummary, Transition::EndRun>();
+    lumiSummary_ = produces<GenWeightSummary, Transition::EndLuminosityBlock>();
 
+    writeEvents_ = iConfig.getUntrackedParameter<bool>("writeEvents", false);
+    lheWeights_ = iConfig.getUntrackedParameter<bool>("lheWeights", false);
+    psWeights_ = iConfig.getUntrackedParameter<bool>("psWeights", false);
+    if (lheWeights_) {
+        lheEventProduct_ = consumes<LHEEventProduct>(iConfig.getParameter<InputTag>("lheEventProduct"));
+    }
+
+    writeProfile_ = TreeWriteProfile(iConfig.getUntrackedParameter<ParameterSet>("writeProfile", ParameterSet()));
+
+    genWeightTree_ = nullptr;
     lumi_ = -1;
     run_ = -1;
     event_ = -1;
     genWeight_ = 0.;
 
-    usesResource();
+    genWeightLumisTree_ = nullptr;
+    genWeightRunsTree_ = nullptr;
 }
 
 
@@ -82,29 +195,150 @@ void GenWeightNtuplizer::fillDescriptions(ConfigurationDescriptions& description
 
 
 void GenWeightNtuplizer::beginJob() {
-    genWeightTree_ = fs_->make<TTree>("genWeights", "genWeights");
-    genWeightTree_->Branch("lumi", &lumi_, "lumi/L");
-    genWeightTree_->Branch("run", &run_,  "run/L");
-    genWeightTree_->Branch("event", &event_, "event/L");
-    genWeightTree_->Branch("genWeight", &genWeight_, "genWeight/F");
+    if (writeEvents_) {
+        genWeightTree_ = fs_->make<TTree>("genWeights", "genWeights");
+        genWeightTree_->Branch("lumi", &lumi_, "lumi/L");
+        genWeightTree_->Branch("run", &run_,  "run/L");
+        genWeightTree_->Branch("event", &event_, "event/L");
+        genWeightTree_->Branch("genWeight", &genWeight_, "genWeight/F");
+        writeProfile_.apply(genWeightTree_);
+    }
+
+    genWeightLumisTree_ = fs_->make<TTree>("genWeightLumis", "genWeightLumis");
+    summaryRecord_.branch(genWeightLumisTree_, true);
+    writeProfile_.apply(genWeightLumisTree_);
+
+    genWeightRunsTree_ = fs_->make<TTree>("genWeightRuns", "genWeightRuns");
+    summaryRecord_.branch(genWeightRunsTree_, false);
+    writeProfile_.apply(genWeightRunsTree_);
 }
 
 
-void GenWeightNtuplizer::analyze(const Event& event, const EventSetup& setup) {
-    Handle<GenEventInfoProduct> genEvtInfo;
+unique_ptr<GenWeightStreamCache> GenWeightNtuplizer::beginStream(StreamID streamID) const {
+    return make_unique<GenWeightStreamCache>();
+}
+
+
+void GenWeightNtuplizer::streamBeginRun(StreamID streamID, const Run& run, const EventSetup& setup) const {
+    streamCache(streamID)->runSummary.clear();
+}
+
+
+void GenWeightNtuplizer::streamBeginLuminosityBlock(StreamID streamID, const LuminosityBlock& lumi, const EventSetup& setup) const {
+    streamCache(streamID)->lumiSummary.clear();
+}
 
-    event.getByToken(genEvtInfo_, genEvtInfo);
 
+void GenWeightNtuplizer::produce(StreamID streamID, Event& event, const EventSetup& setup) const {
+    GenWeightStreamCache* streamCache = this->streamCache(streamID);
+
+    Handle<GenEventInfoProduct> genEvtInfo;
+    event.getByToken(genEvtInfo_, genEvtInfo);
+    const double genWeight = genEvtInfo->weight();
+
+    // the buffers are reused across events, they stay empty if the weights are not summed; an event without the
+    // variations or with a vanishing nominal weight would silently bias or spoil the sums, so it stops the job
+    streamCache->lheEventWeights.clear();
+    if (lheWeights_) {
+        Handle<LHEEventProduct> lheEventProduct;
+        event.getByToken(lheEventProduct_, lheEventProduct);
+        const double originalWeight = lheEventProduct->originalXWGTUP();
+        if (lheEventProduct->weights().empty()) {
+            throw cms::Exception("InvalidGeneratorWeights") << "GenWeightNtuplizer: event " << event.id() << " has no LHE weights, disable lheWeights for this sample";
+        }
+        if (originalWeight == 0.) {
+            throw cms::Exception("InvalidGeneratorWeights") << "GenWeightNtuplizer: event " << event.id() << " has an original LHE weight of zero";
+        }
+        for (const gen::WeightsInfo& weight : lheEventProduct->weights()) {
+            streamCache->lheEventWeights.push_back(genWeight * weight.wgt / originalWeight);
+        }
+    }
+    streamCache->psEventWeights.clear();
+    if (psWeights_) {
+        // the first weight is the nominal one, the parton shower variations follow
+        const vector<double>& weights = genEvtInfo->weights();
+        if (weights.size() < 2) {
+            throw cms::Exception("InvalidGeneratorWeights") << "GenWeightNtuplizer: event " << event.id() << " has no parton shower weights, disable psWeights for this sample";
+        }
+        if (weights[0] == 0.) {
+            throw cms::Exception("InvalidGeneratorWeights") << "GenWeightNtuplizer: event " << event.id() << " has a nominal parton shower weight of zero";
+        }
+        for (size_t i = 1; i < weights.size(); ++i) {
+            streamCache->psEventWeights.push_back(genWeight * weights[i] / weights[0]);
+        }
+    }
+    streamCache->lumiSummary.fill(genWeight, streamCache->lheEventWeights, streamCache->psEventWeights);
+
+    if (!writeEvents_) {
+        return;
+    }
+
+    // the output file is shared with modules that are not serialized with this one
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
     lumi_ = event.luminosityBlock();
     run_ = event.id().run();
     event_ = event.id().event();
-    genWeight_ = static_cast<float>(genEvtInfo->weight());
-
+    genWeight_ = static_cast<float>(genWeight);
     genWeightTree_->Fill();
 }
 
 
-void GenWeightNtuplizer::endJob() {}
+shared_ptr<GenWeightSummary> GenWeightNtuplizer::globalBeginRunSummary(const Run& run, const EventSetup& setup) const {
+    return make_shared<GenWeightSummary>();
+}
+
+
+// called by the framework for one stream at a time
+void GenWeightNtuplizer::streamEndRunSummary(StreamID streamID, const Run& run, const EventSetup& setup, GenWeightSummary* summary) const {
+    summary->add(streamCache(streamID)->runSummary);
+}
+
+
+void GenWeightNtuplizer::globalEndRunSummary(const Run& run, const EventSetup& setup, GenWeightSummary* summary) const {
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
+    summaryRecord_.fill(-1, run.run(), *summary);
+    genWeightRunsTree_->Fill();
+}
+
+
+void GenWeightNtuplizer::globalEndRunProduce(Run& run, const EventSetup& setup, const GenWeightSummary* summary) const {
+    run.put(runSummary_, make_unique<GenWeightSummary>(*summary));
+}
+
+
+shared_ptr<GenWeightSummary> GenWeightNtuplizer::globalBeginLuminosityBlockSummary(const LuminosityBlock& lumi, const EventSetup& setup) const {
+    return make_shared<GenWeightSummary>();
+}
+
+
+// called by the framework for one stream at a time, the stream keeps the sums of the run until its end
+void GenWeightNtuplizer::streamEndLuminosityBlockSummary(StreamID streamID, const LuminosityBlock& lumi, const EventSetup& setup, GenWeightSummary* summary) const {
+    GenWeightStreamCache* streamCache = this->streamCache(streamID);
+    summary->add(streamCache->lumiSummary);
+    streamCache->runSummary.add(streamCache->lumiSummary);
+}
+
+
+void GenWeightNtuplizer::globalEndLuminosityBlockSummary(const LuminosityBlock& lumi, const EventSetup& setup, GenWeightSummary* summary) const {
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
+    summaryRecord_.fill(lumi.luminosityBlock(), lumi.run(), *summary);
+    genWeightLumisTree_->Fill();
+}
+
+
+void GenWeightNtuplizer::globalEndLuminosityBlockProduce(LuminosityBlock& lumi, const EventSetup& setup, const GenWeightSummary* summary) const {
+    lumi.put(lumiSummary_, make_unique<GenWeightSummary>(*summary));
+}
+
+
+void GenWeightNtuplizer::endJob() {
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
+    if (writeEvents_) {
+        LogInfo("GenWeightNtuplizer") << writeProfile_.report(genWeightTree_);
+    }
+    LogInfo("GenWeightNtuplizer") << writeProfile_.report(genWeightLumisTree_);
+    LogInfo("GenWeightNtuplizer") << writeProfile_.report(genWeightRunsTree_);
+}
 
 
 //define this as a plug-in
@@ -7,6 +7,8 @@
 
 // user include files
 
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Common/interface/Ptr.h"
 #include "DataFormats/PatCandidates/interface/Electron.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "DataFormats/PatCandidates/interface/Tau.h"
@@ -21,6 +23,8 @@
 #include "FWCore/Utilities/interface/EDGetToken.h"
 #include "FWCore/Utilities/interface/EDPutToken.h"
 
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPair.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPreselection.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_reco.h"
 
 using namespace edm;
@@ -40,9 +44,21 @@ private:
     void beginJob() override;
     void endJob() override;
 
-    EDGetTokenT<vector<Electron>> pairElectrons_;
-    EDGetTokenT<vector<Muon>> pairMuons_;
-    EDGetTokenT<vector<Tau>> pairTaus_;
+    EDGetTokenT<vector<Electron>> electrons_;
+    EDGetTokenT<vector<Muon>> muons_;
+    EDGetTokenT<vector<Tau>> taus_;
+    EDGetTokenT<TauTauPreselection> preselection_;
+
+    bool filter_;
+    bool storeLegCopies_;
+    TauIDResolver tauIDResolver_;
+    TauTauPairWorkspace tauTauPairWorkspace_;
+
+    EDPutTokenT<TauTauPair> tauTauPair_;
+    EDPutTokenT<int> finalState_;
+    EDPutTokenT<vector<Electron>> pairElectrons_;
+    EDPutTokenT<vector<Muon>> pairMuons_;
+    EDPutTokenT<vector<Tau>> pairTaus_;
 };
 
 
@@ -53,9 +69,24 @@ void RecoTauTauPairFilter::endJob() {};
 
 
 RecoTauTauPairFilter::RecoTauTauPairFilter(const ParameterSet& iConfig) {
-    pairElectrons_ = consumes<vector<Electron>>(iConfig.getParameter<InputTag>("pairElectrons"));
-    pairMuons_ = consumes<vector<Muon>>(iConfig.getParameter<InputTag>("pairMuons"));
-    pairTaus_ = consumes<vector<Tau>>(iConfig.getParameter<InputTag>("pairTaus"));
+    electrons_ = consumes<vector<Electron>>(iConfig.getParameter<InputTag>("electrons"));
+    muons_ = consumes<vector<Muon>>(iConfig.getParameter<InputTag>("muons"));
+    taus_ = consumes<vector<Tau>>(iConfig.getParameter<InputTag>("taus"));
+    preselection_ = consumes<TauTauPreselection>(iConfig.getParameter<InputTag>("preselection"));
+
+    // with filter set to false all events are kept, the pair and the final state are put in any case
+    filter_ = iConfig.getParameter<bool>("filter");
+
+    // copies of the selected legs are only written on request, the pair product points into the input collections
+    storeLegCopies_ = iConfig.getUntrackedParameter<bool>("storeLegCopies", false);
+
+    tauTauPair_ = produces<TauTauPair>();
+    finalState_ = produces<int>("finalState");
+    if (storeLegCopies_) {
+        pairElectrons_ = produces<vector<Electron>>("pairElectrons");
+        pairMuons_ = produces<vector<Muon>>("pairMuons");
+        pairTaus_ = produces<vector<Tau>>("pairTaus");
+    }
 }
 
 
@@ -63,23 +94,93 @@ RecoTauTauPairFilter::~RecoTauTauPairFilter() {}
 
 
 bool RecoTauTauPairFilter::filter(Event& event, const EventSetup& setup) {
-    Handle<vector<Electron>> pairElectrons;
-    Handle<vector<Muon>> pairMuons;
-    Handle<vector<Tau>> pairTaus;
-
-    event.getByToken(pairElectrons_, pairElectrons);
-    event.getByToken(pairMuons_, pairMuons);
-    event.getByToken(pairTaus_, pairTaus);
-
-    if (
-        ((pairElectrons->size() == 1) && (pairMuons->size() == 0) && (pairTaus->size() == 1))
-        || ((pairElectrons->size() == 0) && (pairMuons->size() == 1) && (pairTaus->size() == 1))
-        || ((pairElectrons->size() == 0) && (pairMuons->size() == 0) && (pairTaus->size() == 2))
-    ) {
-        return true;
+    Handle<vector<Electron>> electrons;
+    Handle<vector<Muon>> muons;
+    Handle<vector<Tau>> taus;
+    Handle<TauTauPreselection> preselection;
+
+    event.getByToken(electrons_, electrons);
+    event.getByToken(muons_, muons);
+    event.getByToken(taus_, taus);
+    event.getByToken(preselection_, preselection);
+
+    // all taus of the collection share the layout of their ID list
+    if (!taus->empty()) {
+        tauIDResolver_.update(taus->front());
+    }
+
+    TauTauPairAlgorithm tauTauPairAlgo = TauTauPairAlgorithm(*electrons, *muons, *taus, *preselection, tauIDResolver_, tauTauPairWorkspace_);
+    tauTauPairAlgo.execute();
+
+    unique_ptr<TauTauPair> tauTauPair = make_unique<TauTauPair>();
+    const TauTauFinalState recoFinalState = tauTauPairAlgo.getFinalState();
+    if (recoFinalState == TauTauFinalState::et) {
+        const pair<size_t, size_t> indices = tauTauPairAlgo.getPairIndices();
+        const pair<SortScore, SortScore> sortScores = tauTauPairAlgo.getPairSortScores();
+        *tauTauPair = TauTauPair(
+            recoFinalState,
+            Ptr<reco::Candidate>(electrons, indices.first),
+            Ptr<reco::Candidate>(taus, indices.second),
+            sortScores.first,
+            sortScores.second,
+            0,
+            tauIDResolver_.getIDBits(taus->at(indices.second))
+        );
+    } else if (recoFinalState == TauTauFinalState::mt) {
+        const pair<size_t, size_t> indices = tauTauPairAlgo.getPairIndices();
+        const pair<SortScore, SortScore> sortScores = tauTauPairAlgo.getPairSortScores();
+        *tauTauPair = TauTauPair(
+            recoFinalState,
+            Ptr<reco::Candidate>(muons, indices.first),
+            Ptr<reco::Candidate>(taus, indices.second),
+            sortScores.first,
+            sortScores.second,
+            0,
+            tauIDResolver_.getIDBits(taus->at(indices.second))
+        );
+    } else if (recoFinalState == TauTauFinalState::tt) {
+        const pair<size_t, size_t> indices = tauTauPairAlgo.getPairIndices();
+        const pair<SortScore, SortScore> sortScores = tauTauPairAlgo.getPairSortScores();
+        *tauTauPair = TauTauPair(
+            recoFinalState,
+            Ptr<reco::Candidate>(taus, indices.first),
+            Ptr<reco::Candidate>(taus, indices.second),
+            sortScores.first,
+            sortScores.second,
+            tauIDResolver_.getIDBits(taus->at(indices.first)),
+            tauIDResolver_.getIDBits(taus->at(indices.second))
+        );
+    }
+    event.put(tauTauPair_, move(tauTauPair));
+    event.put(finalState_, make_unique<int>(recoFinalState));
+
+    const bool hasPair = (recoFinalState == TauTauFinalState::et) || (recoFinalState == TauTauFinalState::mt) || (recoFinalState == TauTauFinalState::tt);
+    if (!storeLegCopies_) {
+        return hasPair || !filter_;
+    }
+
+    // the selected legs are copied into the output collections, the algorithm itself works on the input collections
+    unique_ptr<vector<Electron>> pairElectrons = make_unique<vector<Electron>>();
+    unique_ptr<vector<Muon>> pairMuons = make_unique<vector<Muon>>();
+    unique_ptr<vector<Tau>> pairTaus = make_unique<vector<Tau>>();
+    if (recoFinalState == TauTauFinalState::et) {
+        const pair<const Electron&, const Tau&> etPair = tauTauPairAlgo.getPairET();
+        pairElectrons->push_back(etPair.first);
+        pairTaus->push_back(etPair.second);
+    } else if (recoFinalState == TauTauFinalState::mt) {
+        const pair<const Muon&, const Tau&> mtPair = tauTauPairAlgo.getPairMT();
+        pairMuons->push_back(mtPair.first);
+        pairTaus->push_back(mtPair.second);
+    } else if (recoFinalState == TauTauFinalState::tt) {
+        const pair<const Tau&, const Tau&> ttPair = tauTauPairAlgo.getPairTT();
+        pairTaus->push_back(ttPair.first);
+        pairTaus->push_back(ttPair.second);
     }
+    event.put(pairElectrons_, move(pairElectrons));
+    event.put(pairMuons_, move(pairMuons));
+    event.put(pairTaus_, move(pairTaus));
 
-    return false;
+    return hasPair || !filter_;
 }
 
 
@@ -0,0 +1,93 @@
+// system include files
+
+#include <memory>
+#include <vector>
+
+// user include files
+
+#include "DataFormats/PatCandidates/interface/Electron.h"
+#include "DataFormats/PatCandidates/interface/Muon.h"
+#include "DataFormats/PatCandidates/interface/Tau.h"
+
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/one/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/InputTag.h"
+#include "FWCore/Utilities/interface/EDGetToken.h"
+#include "FWCore/Utilities/interface/EDPutToken.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPreselection.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_reco.h"
+
+using namespace edm;
+using namespace std;
+using namespace pat;
+using namespace tautau_selection_reco;
+
+
+class RecoTauTauPreselectionProducer : public one::EDProducer<one::SharedResources> {
+
+public:
+    explicit RecoTauTauPreselectionProducer(const ParameterSet&);
+    ~RecoTauTauPreselectionProducer();
+
+private:
+    void produce(Event&, const EventSetup&) override;
+    void beginJob() override;
+    void endJob() override;
+
+    EDGetTokenT<vector<Electron>> electrons_;
+    EDGetTokenT<vector<Muon>> muons_;
+    EDGetTokenT<vector<Tau>> taus_;
+
+    TauTauPreselector preselector_;
+    TauIDResolver tauIDResolver_;
+
+    EDPutTokenT<TauTauPreselection> preselection_;
+};
+
+
+void RecoTauTauPreselectionProducer::beginJob() {};
+
+
+void RecoTauTauPreselectionProducer::endJob() {};
+
+
+RecoTauTauPreselectionProducer::RecoTauTauPreselectionProducer(const ParameterSet& iConfig) :
+    preselector_(iConfig)
+{
+    electrons_ = consumes<vector<Electron>>(iConfig.getParameter<InputTag>("electrons"));
+    muons_ = consumes<vector<Muon>>(iConfig.getParameter<InputTag>("muons"));
+    taus_ = consumes<vector<Tau>>(iConfig.getParameter<InputTag>("taus"));
+
+    preselection_ = produces<TauTauPreselection>();
+}
+
+
+RecoTauTauPreselectionProducer::~RecoTauTauPreselectionProducer() {}
+
+
+void RecoTauTauPreselectionProducer::produce(Event& event, const EventSetup& setup) {
+    Handle<vector<Electron>> electrons;
+    Handle<vector<Muon>> muons;
+    Handle<vector<Tau>> taus;
+
+    event.getByToken(electrons_, electrons);
+    event.getByToken(muons_, muons);
+    event.getByToken(taus_, taus);
+
+    // all taus of the collection share the layout of their ID list
+    if (!taus->empty()) {
+        tauIDResolver_.update(taus->front());
+    }
+
+    unique_ptr<TauTauPreselection> preselection = make_unique<TauTauPreselection>();
+    preselector_.select(*electrons, *muons, *taus, tauIDResolver_, *preselection);
+    event.put(preselection_, move(preselection));
+}
+
+
+//define this as a plug-in
+DEFINE_FWK_MODULE(RecoTauTauPreselectionProducer);
@@ -17,7 +17,7 @@
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
-#include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenTauTauFinalState.h"
 
 using namespace edm;
 using namespace std;
@@ -36,7 +36,7 @@ private:
     void endJob() override;
     bool filter(Event&, const EventSetup&) override;
 
-    EDGetTokenT<vector<GenParticle>> tauTauGenParticles_;
+    EDGetTokenT<GenTauTauFinalState> genTauTauFinalState_;
 };
 
 
@@ -47,7 +47,7 @@ void TauTauGenParticlesFilter::endJob() {};
 
 
 TauTauGenParticlesFilter::TauTauGenParticlesFilter(const ParameterSet& iConfig) {
-    tauTauGenParticles_ = consumes<vector<GenParticle>>(iConfig.getParameter<InputTag>("tauTauGenParticles"));
+    genTauTauFinalState_ = consumes<GenTauTauFinalState>(iConfig.getParameter<InputTag>("genTauTauFinalState"));
 }
 
 
@@ -55,21 +55,11 @@ TauTauGenParticlesFilter::~TauTauGenParticlesFilter() {}
 
 
 bool TauTauGenParticlesFilter::filter(Event& event, const EventSetup& setup) {
-    Handle<vector<GenParticle>> tauTauGenParticles;
+    Handle<GenTauTauFinalState> genTauTauFinalState;
+    event.getByToken(genTauTauFinalState_, genTauTauFinalState);
 
-    event.getByToken(tauTauGenParticles_, tauTauGenParticles);
-
-    // reject ill-defined events
-    if (tauTauGenParticles->size() < 2) {
-        return false;
-    }
-
-    // get the first two particles, which are the leptons from the Z/gamma* decay
-    const GenParticle& lepton1 = tauTauGenParticles->at(0);
-    const GenParticle& lepton2 = tauTauGenParticles->at(1);
-
-    // get the final state
-    HZGammaFinalState genFinalState = getDileptonFinalState(lepton1, lepton2);
+    // the final state has been classified by the producer of the generator-level pair
+    const HZGammaFinalState genFinalState = genTauTauFinalState->finalState();
 
     if (genFinalState == HZGammaFinalState::unknown) {
         LogWarning("TauTauGenParticlesFilter") << "failed to find generator-level lepton pair";
@@ -1,7 +1,9 @@
 // system include files
 
 #include <cmath>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -20,6 +22,8 @@
 #include "FWCore/Utilities/interface/EDGetToken.h"
 #include "FWCore/Utilities/interface/EDPutToken.h"
 
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenTauTauFinalState.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
 
 using namespace edm;
@@ -40,8 +44,11 @@ private:
     void endJob() override;
 
     EDGetTokenT<vector<GenParticle>> genParticles_;
+    EDGetTokenT<GenDecayTree> genDecayTree_;
+    bool storeDaughters_;
 
     EDPutTokenT<vector<GenParticle>> tauTauGenParticles_;
+    EDPutTokenT<GenTauTauFinalState> genTauTauFinalState_;
 };
 
 
@@ -53,7 +60,12 @@ void TauTauGenParticlesProducer::endJob() {};
 
 TauTauGenParticlesProducer::TauTauGenParticlesProducer(const ParameterSet& iConfig) {
     genParticles_ = consumes<vector<GenParticle>>(iConfig.getParameter<InputTag>("genParticles"));
-    tauTauGenParticles_ = produces<vector<GenParticle>>("tauTauGenParticles");
+    genDecayTree_ = consumes<GenDecayTree>(iConfig.getParameter<InputTag>("genDecayTree"));
+    storeDaughters_ = iConfig.getUntrackedParameter<bool>("storeDaughters", false);
+    if (storeDaughters_) {
+        tauTauGenParticles_ = produces<vector<GenParticle>>("tauTauGenParticles");
+    }
+    genTauTauFinalState_ = produces<GenTauTauFinalState>();
 }
 
 
@@ -63,35 +75,54 @@ TauTauGenParticlesProducer::~TauTauGenParticlesProducer() {}
 void TauTauGenParticlesProducer::produce(Event& event, const EventSetup& setup) {
     Handle<GenParticleCollection> genParticles;
     event.getByToken(genParticles_, genParticles);
+    Handle<GenDecayTree> genDecayTree;
+    event.getByToken(genDecayTree_, genDecayTree);
+    if (genDecayTree->size() != genParticles->size()) {
+        throw logic_error("TauTauGenParticlesProducer: the decay tree has not been built from the generator particles");
+    }
 
-    unique_ptr<vector<GenParticle>> tauTauGenParticles = make_unique<vector<GenParticle>>();
+    uint32_t lepton1 = 0;
+    uint32_t lepton2 = 0;
+    const DileptonSearchStatus status = findPairLeptons(*genDecayTree, lepton1, lepton2);
+    if (status != DileptonSearchStatus::pairFound) {
+        if (status == DileptonSearchStatus::tooManyLeptons) {
+            LogWarning("TauTauGenParticlesProducer") << "failed to find generator-level dilepton pair, more than two hard-process leptons of one flavour";
+        } else if (status == DileptonSearchStatus::sameSignLeptons) {
+            LogWarning("TauTauGenParticlesProducer") << "failed to find generator-level dilepton pair, hard-process leptons have the same charge";
+        } else {
+            LogWarning("TauTauGenParticlesProducer") << "failed to find generator-level dilepton pair";
+        }
+        if (storeDaughters_) {
+            event.put(tauTauGenParticles_, make_unique<vector<GenParticle>>());
+        }
+        event.put(genTauTauFinalState_, make_unique<GenTauTauFinalState>());
+        return;
+    }
 
-    GenParticle lepton1;
-    GenParticle lepton2;
-    bool foundEE = false;
-    bool foundMM = false;
-    bool foundTT = false;
+    // classify the pair and sum the decay products while the decay tree is at hand, so that the filter and the
+    // ntuplizer only read the fixed-size result
+    event.put(genTauTauFinalState_, make_unique<GenTauTauFinalState>(
+        getDileptonFinalState(*genDecayTree, lepton1, lepton2),
+        getLeptonDecay(*genDecayTree, *genParticles, lepton1),
+        getLeptonDecay(*genDecayTree, *genParticles, lepton2)
+    ));
 
-    foundEE = setPairLeptons(*genParticles, 11, lepton1, lepton2); 
-    if (!foundEE) {
-        foundMM = setPairLeptons(*genParticles, 13, lepton1, lepton2); 
-    }
-    if (!foundEE && !foundMM) {
-        foundTT = setPairLeptons(*genParticles, 15, lepton1, lepton2); 
-    }
-    if (!foundEE && !foundMM && !foundTT) {
-        LogWarning("TauTauGenParticlesProducer") << "failed to find generator-level dilepton pair";
-        event.put(tauTauGenParticles_, move(tauTauGenParticles));
+    if (!storeDaughters_) {
         return;
-    } 
+    }
 
-    tauTauGenParticles->push_back(lepton1);
-    tauTauGenParticles->push_back(lepton2);
-    for (const GenParticle& genParticle : getDirectDaughters(lepton1)) {
-        tauTauGenParticles->push_back(genParticle);
+    // the particles are only copied here, when they are written to the output collection
+    unique_ptr<vector<GenParticle>> tauTauGenParticles = make_unique<vector<GenParticle>>();
+    const GenIndexRange daughters1 = getDirectDaughters(*genDecayTree, lepton1);
+    const GenIndexRange daughters2 = getDirectDaughters(*genDecayTree, lepton2);
+    tauTauGenParticles->reserve(2 + daughters1.size() + daughters2.size());
+    tauTauGenParticles->push_back(genParticles->at(lepton1));
+    tauTauGenParticles->push_back(genParticles->at(lepton2));
+    for (const uint32_t daughter : daughters1) {
+        tauTauGenParticles->push_back(genParticles->at(daughter));
     }
-    for (const GenParticle& genParticle : getDirectDaughters(lepton2)) {
-        tauTauGenParticles->push_back(genParticle);
+    for (const uint32_t daughter : daughters2) {
+        tauTauGenParticles->push_back(genParticles->at(daughter));
     }
     event.put(tauTauGenParticles_, move(tauTauGenParticles));
 }
@@ -1,7 +1,12 @@
 // system include files
+#include <algorithm>
 #include <memory>
 #include <cmath>
-#include <regex>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <unordered_map>
 
 
 // user include files
@@ -10,24 +15,37 @@
 
 #include "DataFormats/Common/interface/TriggerResults.h"
 #include "DataFormats/HepMCCandidate/interface/GenParticle.h"
-#include "DataFormats/PatCandidates/interface/Electron.h"
-#include "DataFormats/PatCandidates/interface/Muon.h"
 #include "DataFormats/PatCandidates/interface/Tau.h"
 #include "DataFormats/PatCandidates/interface/TriggerObjectStandAlone.h"
+#include "DataFormats/Provenance/interface/ParameterSetID.h"
 
 #include "FWCore/Framework/interface/Frameworkfwd.h"
-#include "FWCore/Framework/interface/one/EDAnalyzer.h"
+#include "FWCore/Framework/interface/global/EDAnalyzer.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/Run.h"
+#include "FWCore/MessageLogger/interface/MessageLogger.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 #include "FWCore/ServiceRegistry/interface/Service.h"
+#include "FWCore/Utilities/interface/Exception.h"
 #include "FWCore/Utilities/interface/InputTag.h"
 
 #include "HLTrigger/HLTcore/interface/HLTConfigProvider.h"
 
 #include "SimDataFormats/GeneratorProducts/interface/GenEventInfoProduct.h"
 
+#include "TauAnalysis/TauTriggerNtuples/interface/BatchedTreeWriter.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/FilterEfficiencyHistograms.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenTauTauFinalState.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/HighLevelTriggerPath.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/HLTPathSelector.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPair.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTriggerEventRecord.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeBranchBinder.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeWriteProfile.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TriggerFilterIndex.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TriggerObjectMatcher.h"
 
 #include <TTree.h>
 
@@ -36,7 +54,74 @@ using namespace pat;
 using namespace std;
 
 
-class TauTriggerNtuplizer: public one::EDAnalyzer<one::WatchRuns, one::SharedResources> {
+// HLT configuration, id of the HLT menu, selected HLT paths and the lookup of their saveTags filters of a run
+struct TauTriggerRunCache {
+    HLTConfigProvider hltConfig;
+    int hltMenuId;
+    vector<shared_ptr<HighLevelTriggerPath>> hltPaths;
+    TriggerFilterIndex filterIndex;
+    vector<size_t> efficiencyDenominatorSlots;
+    vector<vector<size_t>> efficiencyFilterSlots;
+};
+
+
+enum PairLegType {
+    electronLeg,
+    muonLeg,
+    tauLeg
+};
+
+
+// offline pair leg of the current event, the decay mode of electrons and muons is -1
+struct PairLeg {
+    PairLegType type;
+    int index;
+    double pt;
+    double eta;
+    double phi;
+    double decayMode;
+};
+
+
+// records of the events that have been processed by a stream but have not been handed over to the writer yet, the
+// filter masks of the selected paths for the trigger object that is currently processed, the trigger objects of the
+// current event that have passed a filter of a selected path with their stored index (-1 if not stored) and path masks,
+// the filter masks of the selected paths for the pair legs of the current event, and the efficiency counts of the stream
+struct TauTriggerStreamCache {
+    vector<TauTriggerEventRecord> records;
+    size_t nRecords;
+    vector<uint64_t> pathMasks;
+    vector<size_t> touchedPathSlots;
+    TriggerObjectMatcher matcher;
+    vector<int> matcherObjectIndices;
+    vector<size_t> matcherMaskOffsets;
+    vector<pair<size_t, uint64_t>> matcherMasks;
+    vector<PairLeg> legs;
+    vector<size_t> matches;
+    vector<uint64_t> legPathMasks;
+    FilterEfficiencyHistograms efficiencyHistograms;
+};
+
+
+// records of the events of a luminosity block, collected from the streams when the rows are written in a deterministic
+// order; the rows are sorted within each luminosity block only, so that only one luminosity block is held in memory, and
+// the blocks follow in the order in which they end
+typedef vector<TauTriggerEventRecord> TauTriggerLumiSummary;
+
+
+/*
+ * Ntuple of the offline tau pairs of each event with the trigger decisions and matched trigger objects, and optionally
+ * the efficiency counts of the selected filters.
+ *
+ * As a global module it cannot declare the "TFileService" shared resource. All writes to the output file are instead
+ * serialized with util::getTFileServiceMutex(), which only the modules of this package take; legacy or one:: modules
+ * of other packages that write through the TFileService in the same job are not serialized against this module.
+ */
+class TauTriggerNtuplizer: public global::EDAnalyzer<
+    RunCache<TauTriggerRunCache>,
+    StreamCache<TauTriggerStreamCache>,
+    LuminosityBlockSummaryCache<TauTriggerLumiSummary>
+> {
 
     public:
         explicit TauTriggerNtuplizer(const ParameterSet&);
@@ -46,160 +131,111 @@ class TauTriggerNtuplizer: public one::EDAnalyzer<one::WatchRuns, one::SharedRes
     private:
         virtual void beginJob() override;
         virtual void endJob() override;
-        virtual void beginRun(const Run&, const EventSetup&) override;
-        virtual void endRun(const Run&, const EventSetup&) override;
-        virtual void analyze(const Event&, const EventSetup&) override;
-        const bool isSelectedHLTPath(const string& path);
-
-        HLTConfigProvider hltConfig_;
+        virtual shared_ptr<TauTriggerRunCache> globalBeginRun(const Run&, const EventSetup&) const override;
+        virtual void globalEndRun(const Run&, const EventSetup&) const override;
+        virtual unique_ptr<TauTriggerStreamCache> beginStream(StreamID) const override;
+        virtual void endStream(StreamID) const override;
+        virtual shared_ptr<TauTriggerLumiSummary> globalBeginLuminosityBlockSummary(const LuminosityBlock&, const EventSetup&) const override;
+        virtual void streamEndLuminosityBlockSummary(StreamID, const LuminosityBlock&, const EventSetup&, TauTriggerLumiSummary*) const override;
+        virtual void globalEndLuminosityBlockSummary(const LuminosityBlock&, const EventSetup&, TauTriggerLumiSummary*) const override;
+        virtual void analyze(StreamID, const Event&, const EventSetup&) const override;
+        void flushStream(TauTriggerStreamCache*) const;
+        const bool isSelectedTriggerObjectType(const int&) const;
+        const int getModuleLabelId(const string&, vector<TauTriggerModuleLabelRecord>&) const;
+        void fillPairLeg(TauTriggerStreamCache*, TauTriggerEventRecord&, const PairLegType&, const reco::Candidate&) const;
+        void matchPairLegs(const TauTriggerRunCache*, TauTriggerStreamCache*, TauTriggerEventRecord&) const;
 
         EDGetTokenT<TriggerResults> triggerResults_;
         EDGetTokenT<vector<TriggerObjectStandAlone>> triggerObjects_;
-        EDGetTokenT<vector<Electron>> pairElectrons_;
-        EDGetTokenT<vector<Muon>> pairMuons_;
-        EDGetTokenT<vector<Tau>> pairTaus_;
+        EDGetTokenT<tautau_selection_reco::TauTauPair> tauTauPair_;
         EDGetTokenT<vector<reco::GenParticle>> tauTauGenParticles_;
+        EDGetTokenT<tautau_selection_gen::GenTauTauFinalState> genTauTauFinalState_;
 
         EDGetTokenT<GenEventInfoProduct> genEvtInfo_;
         vector<string> hltPathList_;
+        HLTPathSelector hltPathSelector_;
+        vector<int> triggerObjectTypes_;
         bool isMC_;
         bool isEmb_;
+        bool writeGenParticles_;
         string triggerResultsProcess_;
+        unsigned int batchSize_;
+        bool deterministicOrder_;
+        TreeLayout outputLayout_;
+        bool writeEvents_;
+        bool reducedPrecision_;
+        double triggerMatchDeltaR_;
 
-        Service<TFileService> fs_;
+        TreeWriteProfile writeProfile_;
 
-        vector<shared_ptr<HighLevelTriggerPath>> hltPaths_;
+        // configuration of the efficiency histograms, each stream starts from a copy
+        FilterEfficiencyHistograms efficiencyHistograms_;
+        vector<int> efficiencyLegIndices_;
 
-        TTree* eventsTree_;
-        long int lumiEv_;
-        long int runEv_;
-        long int eventEv_;
-        bool isElTau_;
-        bool isMuTau_;
-        bool isTauTau_;
-        float genWeight_;
-        vector<float> genParticlePt_;
-        vector<float> genParticleEta_;
-        vector<float> genParticlePhi_;
-        vector<float> genParticleMass_;
-        vector<int> genParticleCharge_;
-        vector<int> genParticlePdgId_;
-        vector<float> pairElectronPt_;
-        vector<float> pairElectronEta_;
-        vector<float> pairElectronPhi_;
-        vector<float> pairElectronMass_;
-        vector<int> pairElectronCharge_;
-        vector<int> pairElectronPdgId_;
-        vector<float> pairMuonPt_;
-        vector<float> pairMuonEta_;
-        vector<float> pairMuonPhi_;
-        vector<float> pairMuonMass_;
-        vector<int> pairMuonCharge_;
-        vector<int> pairMuonPdgId_;
-        vector<float> pairTauPt_;
-        vector<float> pairTauEta_;
-        vector<float> pairTauPhi_;
-        vector<float> pairTauMass_;
-        vector<int> pairTauCharge_;
-        vector<int> pairTauPdgId_;
-        vector<float> triggerObjectPt_;
-        vector<float> triggerObjectEta_;
-        vector<float> triggerObjectPhi_;
-        vector<float> triggerObjectMass_;
-        vector<int> triggerObjectCharge_;
-        vector<int> triggerObjectPdgId_;
-        vector<int> triggerObjectType_;
-        vector<int> triggerObjectHLTPathIndex_;
-        vector<int> triggerObjectModuleIndex_;
-        vector<int> eventHltPathIndex_;
-        vector<int> eventHltPathLastModule_;
-        vector<int> eventHltPathLastModuleState_;
+        // counts of all streams, merged at the end of each stream
+        mutable FilterEfficiencyHistograms mergedEfficiencyHistograms_;
+        mutable mutex efficiencyMutex_;
+
+        Service<TFileService> fs_;
 
+        TTree* eventsTree_;
         TTree* hltTree_;
-        long int runTr_;
-        string hltGlobalTag_;
-        string hltTableName_;
-        string hltPathName_;
-        string hltPathVersion_;
-        int hltPathIndex_;
-        vector<string> hltPathModules_;
-        vector<string> hltPathModulesSaveTags_;
+        TTree* hltModuleLabelsTree_;
+
+        // thread-safe: the writers serialize all tree access with the mutex of the output file
+        mutable BatchedTreeWriter<TauTriggerEventRecord> eventsWriter_;
+        mutable BatchedTreeWriter<TauTriggerHLTRecord> hltWriter_;
+        mutable BatchedTreeWriter<TauTriggerModuleLabelRecord> hltModuleLabelsWriter_;
+
+        // ids of the HLT menus, identified by table name and process configuration, and of the module labels that have
+        // been written to the 'HLT' and 'HLTModuleLabels' trees
+        mutable mutex hltMenuMutex_;
+        mutable map<pair<string, ParameterSetID>, int> hltMenuIds_;
+        mutable unordered_map<string, int> hltModuleLabelIds_;
 };
 
 
 TauTriggerNtuplizer::TauTriggerNtuplizer(const ParameterSet& iConfig) {
     triggerResults_ = consumes<TriggerResults>(iConfig.getParameter<InputTag>("triggerResults"));
     triggerObjects_ = consumes<vector<TriggerObjectStandAlone>>(iConfig.getParameter<InputTag>("triggerObjects"));
-    pairElectrons_ = consumes<vector<Electron>>(iConfig.getParameter<InputTag>("pairElectrons"));
-    pairMuons_ = consumes<vector<Muon>>(iConfig.getParameter<InputTag>("pairMuons"));
-    pairTaus_ = consumes<vector<Tau>>(iConfig.getParameter<InputTag>("pairTaus"));
-    tauTauGenParticles_ = consumes<vector<reco::GenParticle>>(iConfig.getParameter<InputTag>("tauTauGenParticles"));
+    tauTauPair_ = consumes<tautau_selection_reco::TauTauPair>(iConfig.getParameter<InputTag>("tauTauPair"));
+    genTauTauFinalState_ = consumes<tautau_selection_gen::GenTauTauFinalState>(iConfig.getParameter<InputTag>("genTauTauFinalState"));
 
-    hltPathList_ = iConfig.getUntrackedParameter<vector<string>>("hltPathList", hltPathList_);
+    hltPathList_ = iConfig.getUntrackedParameter<vector<string>>("hltPathList", vector<string>());
+    hltPathSelector_ = HLTPathSelector(hltPathList_);
+    triggerObjectTypes_ = iConfig.getUntrackedParameter<vector<int>>("triggerObjectTypes", vector<int>());
     triggerResultsProcess_ = iConfig.getParameter<InputTag>("triggerResults").process();
-    isMC_ = iConfig.getUntrackedParameter<bool>("isMC", isMC_);
-    isEmb_ = iConfig.getUntrackedParameter<bool>("isEmb", isEmb_);
+    isMC_ = iConfig.getUntrackedParameter<bool>("isMC", false);
+    isEmb_ = iConfig.getUntrackedParameter<bool>("isEmb", false);
+    writeGenParticles_ = iConfig.getUntrackedParameter<bool>("writeGenParticles", false);
+    batchSize_ = max(iConfig.getUntrackedParameter<unsigned int>("batchSize", 100), 1u);
+    deterministicOrder_ = iConfig.getUntrackedParameter<bool>("deterministicOrder", false);
+    outputLayout_ = getTreeLayout(iConfig.getUntrackedParameter<string>("outputLayout", "vector"));
+    writeEvents_ = iConfig.getUntrackedParameter<bool>("writeEvents", true);
+    reducedPrecision_ = iConfig.getUntrackedParameter<bool>("reducedPrecision", false);
+    triggerMatchDeltaR_ = iConfig.getUntrackedParameter<double>("triggerMatchDeltaR", 0.5);
+    efficiencyHistograms_ = FilterEfficiencyHistograms(iConfig.getUntrackedParameter<ParameterSet>("efficiencyHistograms", ParameterSet()));
+    efficiencyLegIndices_ = vector<int>({
+        efficiencyHistograms_.legIndex("electron"),
+        efficiencyHistograms_.legIndex("muon"),
+        efficiencyHistograms_.legIndex("tau")
+    });
+    mergedEfficiencyHistograms_ = efficiencyHistograms_;
+    writeProfile_ = TreeWriteProfile(iConfig.getUntrackedParameter<ParameterSet>("writeProfile", ParameterSet()));
 
     if (isMC_ || isEmb_) {
         genEvtInfo_ = consumes<GenEventInfoProduct>(iConfig.getParameter<InputTag>("generator"));
     }
+    // the full daughter dump is only produced on request, see the storeDaughters option of TauTauGenParticlesProducer
+    if ((isMC_ || isEmb_) && writeGenParticles_) {
+        tauTauGenParticles_ = consumes<vector<reco::GenParticle>>(iConfig.getParameter<InputTag>("tauTauGenParticles"));
+    }
 
-    hltPaths_ = vector<shared_ptr<HighLevelTriggerPath>>();
-
-    lumiEv_ = -1;
-    runEv_ = -1;
-    eventEv_ = -1;
-    isElTau_ = false;
-    isMuTau_ = false;
-    isTauTau_ = false;
-    genWeight_ = 1.;
-    genParticlePt_ = vector<float>();
-    genParticleEta_ = vector<float>();
-    genParticlePhi_ = vector<float>();
-    genParticleMass_ = vector<float>();
-    genParticleCharge_ = vector<int>();
-    genParticlePdgId_ = vector<int>();
-    pairElectronPt_ = vector<float>();
-    pairElectronEta_ = vector<float>();
-    pairElectronPhi_ = vector<float>();
-    pairElectronMass_ = vector<float>();
-    pairElectronCharge_ = vector<int>();
-    pairElectronPdgId_ = vector<int>();
-    pairMuonPt_ = vector<float>();
-    pairMuonEta_ = vector<float>();
-    pairMuonPhi_ = vector<float>();
-    pairMuonMass_ = vector<float>();
-    pairMuonCharge_ = vector<int>();
-    pairMuonPdgId_ = vector<int>();
-    pairTauPt_ = vector<float>();
-    pairTauEta_ = vector<float>();
-    pairTauPhi_ = vector<float>();
-    pairTauMass_ = vector<float>();
-    pairTauCharge_ = vector<int>();
-    pairTauPdgId_ = vector<int>();
-    triggerObjectPt_ = vector<float>();
-    triggerObjectEta_ = vector<float>();
-    triggerObjectPhi_ = vector<float>();
-    triggerObjectMass_ = vector<float>();
-    triggerObjectCharge_ = vector<int>();
-    triggerObjectPdgId_ = vector<int>();
-    triggerObjectType_ = vector<int>();
-    triggerObjectHLTPathIndex_ = vector<int>();
-    triggerObjectModuleIndex_ = vector<int>();
-    eventHltPathIndex_ = vector<int>();
-    eventHltPathLastModule_ = vector<int>();
-    eventHltPathLastModuleState_ = vector<int>();
-
-    runTr_ = -1;
-    hltGlobalTag_ = "";
-    hltTableName_ = "";
-    hltPathName_ = "";
-    hltPathVersion_ = "";
-    hltPathIndex_ = -1;
-    hltPathModules_ = vector<string>();
-    hltPathModulesSaveTags_ = vector<string>();
-
-    usesResource();
+    eventsTree_ = nullptr;
+    hltTree_ = nullptr;
+    hltModuleLabelsTree_ = nullptr;
+    hltMenuIds_ = map<pair<string, ParameterSetID>, int>();
+    hltModuleLabelIds_ = unordered_map<string, int>();
 }
 
 void TauTriggerNtuplizer::fillDescriptions(ConfigurationDescriptions& descriptions) {
@@ -212,286 +248,441 @@ void TauTriggerNtuplizer::fillDescriptions(ConfigurationDescriptions& descriptio
 
 void TauTriggerNtuplizer::beginJob() {
     eventsTree_ = fs_->make<TTree>("Events", "Events");
-    eventsTree_->Branch("lumi", &lumiEv_, "lumi/L");
-    eventsTree_->Branch("run", &runEv_,  "run/L");
-    eventsTree_->Branch("event", &eventEv_, "event/L");
-    eventsTree_->Branch("isElTau", &isElTau_, "isElTau/O");
-    eventsTree_->Branch("isMuTau", &isMuTau_, "isMuTau/O");
-    eventsTree_->Branch("isTauTau", &isTauTau_, "isTauTau/O");
-    eventsTree_->Branch("genWeight", &genWeight_, "genWeight/F");
-    eventsTree_->Branch("genParticlePt", &genParticlePt_);
-    eventsTree_->Branch("genParticleEta", &genParticleEta_);
-    eventsTree_->Branch("genParticlePhi", &genParticlePhi_);
-    eventsTree_->Branch("genParticleMass", &genParticleMass_);
-    eventsTree_->Branch("genParticleCharge", &genParticleCharge_);
-    eventsTree_->Branch("genParticlePdgId", &genParticlePdgId_);
-    eventsTree_->Branch("pairElectronPt", &pairElectronPt_);
-    eventsTree_->Branch("pairElectronEta", &pairElectronEta_);
-    eventsTree_->Branch("pairElectronPhi", &pairElectronPhi_);
-    eventsTree_->Branch("pairElectronMass", &pairElectronMass_);
-    eventsTree_->Branch("pairElectronCharge", &pairElectronCharge_);
-    eventsTree_->Branch("pairElectronPdgId", &pairElectronPdgId_);
-    eventsTree_->Branch("pairMuonPt", &pairMuonPt_);
-    eventsTree_->Branch("pairMuonEta", &pairMuonEta_);
-    eventsTree_->Branch("pairMuonPhi", &pairMuonPhi_);
-    eventsTree_->Branch("pairMuonMass", &pairMuonMass_);
-    eventsTree_->Branch("pairMuonCharge", &pairMuonCharge_);
-    eventsTree_->Branch("pairMuonPdgId", &pairMuonPdgId_);
-    eventsTree_->Branch("pairTauPt", &pairTauPt_);
-    eventsTree_->Branch("pairTauEta", &pairTauEta_);
-    eventsTree_->Branch("pairTauPhi", &pairTauPhi_);
-    eventsTree_->Branch("pairTauMass", &pairTauMass_);
-    eventsTree_->Branch("pairTauCharge", &pairTauCharge_);
-    eventsTree_->Branch("pairTauPdgId", &pairTauPdgId_);
-    eventsTree_->Branch("triggerObjectPt", &triggerObjectPt_);
-    eventsTree_->Branch("triggerObjectEta", &triggerObjectEta_);
-    eventsTree_->Branch("triggerObjectPhi", &triggerObjectPhi_);
-    eventsTree_->Branch("triggerObjectMass", &triggerObjectMass_);
-    eventsTree_->Branch("triggerObjectCharge", &triggerObjectCharge_);
-    eventsTree_->Branch("triggerObjectPdgId", &triggerObjectPdgId_);
-    eventsTree_->Branch("triggerObjectType", &triggerObjectType_);
-    eventsTree_->Branch("triggerObjectHLTPathIndex", &triggerObjectHLTPathIndex_);
-    eventsTree_->Branch("triggerObjectModuleIndex", &triggerObjectModuleIndex_);
-    eventsTree_->Branch("hltPathIndex", &eventHltPathIndex_);
-    eventsTree_->Branch("hltPathLastModule", &eventHltPathLastModule_);
-    eventsTree_->Branch("hltPathLastModuleState", &eventHltPathLastModuleState_);
+    eventsWriter_.book(eventsTree_, deterministicOrder_, outputLayout_);
+    writeProfile_.apply(eventsTree_);
 
     hltTree_ = fs_->make<TTree>("HLT", "HLT");
-    hltTree_->Branch("run", &runTr_, "run/L");
-    hltTree_->Branch("hltTableName", &hltTableName_);
-    hltTree_->Branch("hltGlobalTag", &hltGlobalTag_);
-    hltTree_->Branch("hltPathName", &hltPathName_);
-    hltTree_->Branch("hltPathVersion", &hltPathVersion_);
-    hltTree_->Branch("hltPathIndex", &hltPathIndex_);
-    hltTree_->Branch("hltPathModules", &hltPathModules_);
-    hltTree_->Branch("hltPathModulesSaveTags", &hltPathModulesSaveTags_);
+    // the rows of the 'HLT' tree hold string lists, which have no flat representation
+    hltWriter_.book(hltTree_, false, TreeLayout::vectorBranches);
+    writeProfile_.apply(hltTree_);
+
+    hltModuleLabelsTree_ = fs_->make<TTree>("HLTModuleLabels", "HLTModuleLabels");
+    hltModuleLabelsWriter_.book(hltModuleLabelsTree_, false, TreeLayout::vectorBranches);
+    writeProfile_.apply(hltModuleLabelsTree_);
 }
 
-void TauTriggerNtuplizer::beginRun(const Run& run, const EventSetup& setup) {
+shared_ptr<TauTriggerRunCache> TauTriggerNtuplizer::globalBeginRun(const Run& run, const EventSetup& setup) const {
+    shared_ptr<TauTriggerRunCache> runCache = make_shared<TauTriggerRunCache>();
+    runCache->hltMenuId = -1;
 
     bool changed = true;
 
     // initialize the config for this run
-    hltConfig_.init(run, setup, triggerResultsProcess_, changed);
-
-    if (changed) {
-        // empty the old filter list, paths of different runs might have different version numbers
-        hltPaths_.clear();
-
-        // get the table name and the global tag
-        hltTableName_ = hltConfig_.tableName();
-        hltGlobalTag_ = hltConfig_.globalTag();
-    
-        runTr_ = run.id().run();
-
-        // loop through all trigger paths and process paths that have been selected in the python config file
-        vector<string> triggerNames = hltConfig_.triggerNames();
-        for (size_t i = 0; i < triggerNames.size(); ++i) {
-            string fullName = triggerNames.at(i);
-            if (! isSelectedHLTPath(fullName)) {
-                continue;
-            }
-            shared_ptr<HighLevelTriggerPath> hltPath = make_shared<HighLevelTriggerPath>(fullName, i, hltConfig_.moduleLabels(fullName),  hltConfig_.saveTagsModules(fullName));
-            hltPaths_.push_back(hltPath);
-
-            hltPathModules_.clear();
-            hltPathModulesSaveTags_.clear();
-
-            hltPathName_ = hltPath->fullName();
-            hltPathVersion_ = "v";
-            hltPathIndex_ = hltPath->index();
-            hltPathModulesSaveTags_.clear();
-            for (const string& module : hltPath->modules()) {
-                hltPathModules_.push_back(module);
-            }
+    if (!runCache->hltConfig.init(run, setup, triggerResultsProcess_, changed)) {
+        LogError("TauTriggerNtuplizer") << "failed to initialize the HLT configuration of process '" << triggerResultsProcess_ << "'";
+        return runCache;
+    }
+
+    // loop through all trigger paths and process paths that have been selected in the python config file
+    // paths of different runs might have different version numbers
+    const HLTConfigProvider& hltConfig = runCache->hltConfig;
+    const vector<string>& triggerNames = hltConfig.triggerNames();
+    for (size_t i = 0; i < triggerNames.size(); ++i) {
+        const string& fullName = triggerNames.at(i);
+        if (! hltPathSelector_.isSelected(fullName)) {
+            continue;
+        }
+        runCache->hltPaths.push_back(make_shared<HighLevelTriggerPath>(fullName, i, hltConfig.moduleLabels(fullName),  hltConfig.saveTagsModules(fullName)));
+        if (runCache->hltPaths.back()->modulesSaveTags().size() > 64) {
+            LogWarning("TauTriggerNtuplizer") << "HLT path '" << fullName << "' has more than 64 saveTags filters, only the first 64 are encoded in the filter masks";
+        }
+    }
+    runCache->filterIndex = TriggerFilterIndex(runCache->hltPaths);
+
+    // the efficiency counts are keyed by the path name without version, so that the runs of one path are combined; the
+    // keys are resolved to slots once per run, the events fill the counts by slot
+    if (efficiencyHistograms_.enabled()) {
+        for (const shared_ptr<HighLevelTriggerPath>& hltPath : runCache->hltPaths) {
+            runCache->efficiencyDenominatorSlots.push_back(efficiencyHistograms_.slot(FilterEfficiencyHistograms::denominatorKey(hltPath->name())));
+            runCache->efficiencyFilterSlots.push_back(vector<size_t>());
             for (const string& module : hltPath->modulesSaveTags()) {
-                hltPathModulesSaveTags_.push_back(module);
+                runCache->efficiencyFilterSlots.back().push_back(efficiencyHistograms_.slot(FilterEfficiencyHistograms::filterKey(hltPath->name(), module)));
             }
-            hltTree_->Fill();
         }
     }
+
+    // runs with the same HLT menu share its id, the menu is only written for the first of these runs
+    lock_guard<mutex> lock(hltMenuMutex_);
+    const pair<string, ParameterSetID> hltMenuKey = make_pair(hltConfig.tableName(), hltConfig.processPSet().id());
+    const map<pair<string, ParameterSetID>, int>::const_iterator hltMenu = hltMenuIds_.find(hltMenuKey);
+    if (hltMenu != hltMenuIds_.end()) {
+        runCache->hltMenuId = hltMenu->second;
+        return runCache;
+    }
+    runCache->hltMenuId = hltMenuIds_.size();
+    hltMenuIds_[hltMenuKey] = runCache->hltMenuId;
+
+    string hltProcessPSetHash = "";
+    hltMenuKey.second.toString(hltProcessPSetHash);
+
+    vector<TauTriggerHLTRecord> hltRecords = vector<TauTriggerHLTRecord>(runCache->hltPaths.size());
+    vector<TauTriggerModuleLabelRecord> moduleLabelRecords = vector<TauTriggerModuleLabelRecord>();
+    for (size_t i = 0; i < runCache->hltPaths.size(); ++i) {
+        const shared_ptr<HighLevelTriggerPath>& hltPath = runCache->hltPaths.at(i);
+        TauTriggerHLTRecord& hltRecord = hltRecords.at(i);
+        hltRecord.hltMenuId = runCache->hltMenuId;
+        hltRecord.hltTableName = hltConfig.tableName();
+        hltRecord.hltGlobalTag = hltConfig.globalTag();
+        hltRecord.hltProcessPSetHash = hltProcessPSetHash;
+        hltRecord.hltPathSlot = i;
+        hltRecord.hltPathName = hltPath->fullName();
+        hltRecord.hltPathVersion = hltPath->version();
+        hltRecord.hltPathIndex = hltPath->index();
+        for (const string& module : hltPath->modules()) {
+            hltRecord.hltPathModuleLabelIds.push_back(getModuleLabelId(module, moduleLabelRecords));
+        }
+        for (const string& module : hltPath->modulesSaveTags()) {
+            hltRecord.hltPathSaveTagsLabelIds.push_back(getModuleLabelId(module, moduleLabelRecords));
+        }
+    }
+    hltModuleLabelsWriter_.write(moduleLabelRecords, moduleLabelRecords.size());
+    hltWriter_.write(hltRecords, hltRecords.size());
+
+    return runCache;
 }
 
-void TauTriggerNtuplizer::analyze(const Event& event, const EventSetup& setup) {
+unique_ptr<TauTriggerStreamCache> TauTriggerNtuplizer::beginStream(StreamID streamID) const {
+    unique_ptr<TauTriggerStreamCache> streamCache = make_unique<TauTriggerStreamCache>();
+    streamCache->records = vector<TauTriggerEventRecord>(batchSize_);
+    streamCache->nRecords = 0;
+    streamCache->pathMasks = vector<uint64_t>();
+    streamCache->touchedPathSlots = vector<size_t>();
+    streamCache->matcher = TriggerObjectMatcher(triggerMatchDeltaR_);
+    streamCache->matcherObjectIndices = vector<int>();
+    streamCache->matcherMaskOffsets = vector<size_t>();
+    streamCache->matcherMasks = vector<pair<size_t, uint64_t>>();
+    streamCache->legs = vector<PairLeg>();
+    streamCache->matches = vector<size_t>();
+    streamCache->legPathMasks = vector<uint64_t>();
+    streamCache->efficiencyHistograms = efficiencyHistograms_;
+    return streamCache;
+}
+
+void TauTriggerNtuplizer::analyze(StreamID streamID, const Event& event, const EventSetup& setup) const {
+    const TauTriggerRunCache* runCache = this->runCache(event.getRun().index());
+    TauTriggerStreamCache* streamCache = this->streamCache(streamID);
+
     Handle<TriggerResults> triggerResults;
     Handle<vector<TriggerObjectStandAlone>> triggerObjects;
-    Handle<vector<Electron>> pairElectrons;
-    Handle<vector<Muon>> pairMuons;
-    Handle<vector<Tau>> pairTaus;
+    Handle<tautau_selection_reco::TauTauPair> tauTauPair;
 
     event.getByToken(triggerResults_, triggerResults);
     event.getByToken(triggerObjects_, triggerObjects);
-    event.getByToken(pairElectrons_, pairElectrons);
-    event.getByToken(pairMuons_, pairMuons);
-    event.getByToken(pairTaus_, pairTaus);
-
-    lumiEv_ = event.luminosityBlock();
-    runEv_ = event.id().run();
-    eventEv_ = event.id().event();
-
-    isElTau_ = false;
-    isMuTau_ = false;
-    isTauTau_ = false;
-
-    if ((pairElectrons->size() == 1) && (pairMuons->size() == 0) && (pairTaus->size() == 1)) {
-        isElTau_ = true;
-    } else if ((pairElectrons->size() == 0) && (pairMuons->size() == 1) && (pairTaus->size() == 1)) {
-        isMuTau_ = true;
-    } else if ((pairElectrons->size() == 0) && (pairMuons->size() == 0) && (pairTaus->size() == 2)) {
-        isTauTau_ = true;
-    }
+    event.getByToken(tauTauPair_, tauTauPair);
+
+    TauTriggerEventRecord& record = streamCache->records.at(streamCache->nRecords);
+    record.clear();
+
+    record.lumi = event.luminosityBlock();
+    record.run = event.id().run();
+    record.event = event.id().event();
+    record.hltMenuId = runCache->hltMenuId;
+
+    const tautau_selection_reco::TauTauFinalState finalState = tauTauPair->finalState();
+    record.isElTau = (finalState == tautau_selection_reco::TauTauFinalState::et);
+    record.isMuTau = (finalState == tautau_selection_reco::TauTauFinalState::mt);
+    record.isTauTau = (finalState == tautau_selection_reco::TauTauFinalState::tt);
 
-    genWeight_ = 1.;
     if (isMC_ || isEmb_) {
         Handle<GenEventInfoProduct> genEvtInfo;
         event.getByToken(genEvtInfo_, genEvtInfo);
-        genWeight_ = static_cast<float>(genEvtInfo->weight());
+        record.genWeight = static_cast<float>(genEvtInfo->weight());
     }
 
-    genParticlePt_.clear();
-    genParticleEta_.clear();
-    genParticlePhi_.clear();
-    genParticleMass_.clear();
-    genParticleCharge_.clear();
-    genParticlePdgId_.clear();
-
-    if (isMC_ || isEmb_) {
+    if ((isMC_ || isEmb_) && writeGenParticles_) {
         Handle<vector<reco::GenParticle>> tauTauGenParticles;
         event.getByToken(tauTauGenParticles_, tauTauGenParticles);
-        for (const reco::GenParticle& genParticle : *tauTauGenParticles) {
-            genParticlePt_.push_back(genParticle.pt());
-            genParticleEta_.push_back(genParticle.eta());
-            genParticlePhi_.push_back(genParticle.phi());
-            genParticleMass_.push_back(genParticle.mass());
-            genParticleCharge_.push_back(genParticle.charge());
-            genParticlePdgId_.push_back(genParticle.pdgId());
+        if (!tauTauGenParticles.isValid()) {
+            throw cms::Exception("Configuration") << "TauTriggerNtuplizer: writeGenParticles requires the storeDaughters option of "
+                << "TauTauGenParticlesProducer to be set";
         }
+        record.genParticles.fill(*tauTauGenParticles);
     }
 
-    pairElectronPt_.clear();
-    pairElectronEta_.clear();
-    pairElectronPhi_.clear();
-    pairElectronMass_.clear();
-    pairElectronCharge_.clear();
-    pairElectronPdgId_.clear();
-
-    for (const Electron& electron : *pairElectrons) {
-        pairElectronPt_.push_back(electron.pt());
-        pairElectronEta_.push_back(electron.eta());
-        pairElectronPhi_.push_back(electron.phi());
-        pairElectronMass_.push_back(electron.mass());
-        pairElectronCharge_.push_back(electron.charge());
-        pairElectronPdgId_.push_back(electron.pdgId());
-    }
-
-    pairMuonPt_.clear();
-    pairMuonEta_.clear();
-    pairMuonPhi_.clear();
-    pairMuonMass_.clear();
-    pairMuonCharge_.clear();
-    pairMuonPdgId_.clear();
-
-    for (const Muon& muon : *pairMuons) {
-        pairMuonPt_.push_back(muon.pt());
-        pairMuonEta_.push_back(muon.eta());
-        pairMuonPhi_.push_back(muon.phi());
-        pairMuonMass_.push_back(muon.mass());
-        pairMuonCharge_.push_back(muon.charge());
-        pairMuonPdgId_.push_back(muon.pdgId());
+    if (isMC_ || isEmb_) {
+        // the classification of the generator-level pair is read from its producer, the tree is not walked again
+        Handle<tautau_selection_gen::GenTauTauFinalState> genTauTauFinalState;
+        event.getByToken(genTauTauFinalState_, genTauTauFinalState);
+        record.genFinalState = genTauTauFinalState->finalState();
+        record.genTau1.fill(genTauTauFinalState->firstTau());
+        record.genTau2.fill(genTauTauFinalState->secondTau());
     }
 
-    pairTauPt_.clear();
-    pairTauEta_.clear();
-    pairTauPhi_.clear();
-    pairTauMass_.clear();
-    pairTauCharge_.clear();
-    pairTauPdgId_.clear();
-
-    for (const Tau& tau : *pairTaus) {
-        pairTauPt_.push_back(tau.pt());
-        pairTauEta_.push_back(tau.eta());
-        pairTauPhi_.push_back(tau.phi());
-        pairTauMass_.push_back(tau.mass());
-        pairTauCharge_.push_back(tau.charge());
-        pairTauPdgId_.push_back(tau.pdgId());
+    // the first leg is the electron or muon in the semi-leptonic final states
+    streamCache->legs.clear();
+    if (record.isElTau) {
+        fillPairLeg(streamCache, record, electronLeg, *tauTauPair->first());
+        fillPairLeg(streamCache, record, tauLeg, *tauTauPair->second());
+    } else if (record.isMuTau) {
+        fillPairLeg(streamCache, record, muonLeg, *tauTauPair->first());
+        fillPairLeg(streamCache, record, tauLeg, *tauTauPair->second());
+    } else if (record.isTauTau) {
+        fillPairLeg(streamCache, record, tauLeg, *tauTauPair->first());
+        fillPairLeg(streamCache, record, tauLeg, *tauTauPair->second());
     }
 
-    eventHltPathIndex_.clear();
-    eventHltPathLastModule_.clear();
-    eventHltPathLastModuleState_.clear();
-
-    for (const shared_ptr<HighLevelTriggerPath> hltPath : hltPaths_) {
-        int hltPathIndex = hltConfig_.triggerIndex(hltPath->fullName());
-        eventHltPathIndex_.push_back(hltPathIndex);
-        eventHltPathLastModule_.push_back((*triggerResults).index(hltPathIndex));
-        eventHltPathLastModuleState_.push_back((*triggerResults).state(hltPathIndex));
+    for (const shared_ptr<HighLevelTriggerPath>& hltPath : runCache->hltPaths) {
+        const int hltPathIndex = hltPath->index();
+        record.hltPathLastModule.push_back((*triggerResults).index(hltPathIndex));
+        record.hltPathLastModuleState.push_back((*triggerResults).state(hltPathIndex));
+        record.hltPathSaveTagsMask.push_back(hltPath->saveTagsMask((*triggerResults).index(hltPathIndex), (*triggerResults).accept(hltPathIndex)));
     }
 
-    triggerObjectPt_.clear();
-    triggerObjectEta_.clear();
-    triggerObjectPhi_.clear();
-    triggerObjectMass_.clear();
-    triggerObjectCharge_.clear();
-    triggerObjectPdgId_.clear();
-    triggerObjectType_.clear();
-    triggerObjectHLTPathIndex_.clear();
-    triggerObjectModuleIndex_.clear();
-
+    // a filter label of a trigger object that belongs to the saveTags filters of a path implies that the object is
+    // associated with this path, so one lookup per filter label is sufficient
+    // each object is stored once, its associations with the filters of the selected paths are stored separately
+    streamCache->pathMasks.assign(runCache->hltPaths.size(), 0);
+    streamCache->touchedPathSlots.clear();
+    streamCache->matcher.clear();
+    streamCache->matcherObjectIndices.clear();
+    streamCache->matcherMaskOffsets.assign(1, 0);
+    streamCache->matcherMasks.clear();
     for (const TriggerObjectStandAlone& trigObj : *triggerObjects) {
+        const int trigObjIndex = record.triggerObjects.size();
+        bool isAssociated = false;
 
-        for (const string& trigObjPathName : trigObj.pathNames(false, false)) {
+        for (const string& trigObjModule : trigObj.filterLabels()) {
+            const pair<const TriggerFilterEntry*, const TriggerFilterEntry*> entries = runCache->filterIndex.find(trigObjModule);
 
-            for (const shared_ptr<HighLevelTriggerPath> hltPath : hltPaths_) {
-                if (hltPath->fullName() != trigObjPathName) {
-                    continue;
+            for (const TriggerFilterEntry* entry = entries.first; entry != entries.second; ++entry) {
+
+                // the bits of the mask follow the order of the saveTags filters of the path
+                uint64_t& pathMask = streamCache->pathMasks[entry->pathSlot];
+                if (entry->saveTagsIndex < 64) {
+                    if (pathMask == 0) {
+                        streamCache->touchedPathSlots.push_back(entry->pathSlot);
+                    }
+                    pathMask |= (uint64_t(1) << entry->saveTagsIndex);
                 }
-                const int hltPathIndex = hltPath->index();
 
-                for (const string& trigObjModule : trigObj.filterLabels()) {
-                    if (!hltPath->isInModulesSaveTags(trigObjModule)) {
+                for (const int& trigObjType : trigObj.triggerObjectTypes()) {
+                    if (!isSelectedTriggerObjectType(trigObjType)) {
                         continue;
                     }
-                    const int trigObjModuleIndex = hltPath->moduleIndex(trigObjModule);
-
-                    for (const int& trigObjType : trigObj.triggerObjectTypes()) {
-                        triggerObjectPt_.push_back(trigObj.pt());
-                        triggerObjectEta_.push_back(trigObj.eta());
-                        triggerObjectPhi_.push_back(trigObj.phi());
-                        triggerObjectMass_.push_back(trigObj.mass());
-                        triggerObjectCharge_.push_back(trigObj.charge());
-                        triggerObjectPdgId_.push_back(trigObj.pdgId());
-                        triggerObjectHLTPathIndex_.push_back(hltPathIndex);
-                        triggerObjectModuleIndex_.push_back(trigObjModuleIndex);
-                        triggerObjectType_.push_back(trigObjType);
-                    }
+                    record.triggerAssocObjectIndex.push_back(trigObjIndex);
+                    record.triggerAssocHLTPathIndex.push_back(entry->hltPathIndex);
+                    record.triggerAssocModuleIndex.push_back(entry->moduleIndex);
+                    record.triggerAssocType.push_back(trigObjType);
+                    isAssociated = true;
                 }
             }
         }
+
+        if (isAssociated) {
+            record.triggerObjects.push_back(trigObj);
+        }
+
+        // only objects that have passed a filter of a selected path take part in the matching to the pair legs
+        if (!streamCache->touchedPathSlots.empty()) {
+            streamCache->matcher.add(trigObj.eta(), trigObj.phi());
+            streamCache->matcherObjectIndices.push_back(isAssociated ? trigObjIndex : -1);
+        }
+
+        for (const size_t& pathSlot : streamCache->touchedPathSlots) {
+            streamCache->matcherMasks.push_back(make_pair(pathSlot, streamCache->pathMasks[pathSlot]));
+            if (isAssociated) {
+                record.triggerObjectPathObjectIndex.push_back(trigObjIndex);
+                record.triggerObjectPathHLTPathIndex.push_back(runCache->hltPaths[pathSlot]->index());
+                record.triggerObjectPathMask.push_back(streamCache->pathMasks[pathSlot]);
+            }
+            streamCache->pathMasks[pathSlot] = 0;
+        }
+        if (!streamCache->touchedPathSlots.empty()) {
+            streamCache->matcherMaskOffsets.push_back(streamCache->matcherMasks.size());
+        }
+        streamCache->touchedPathSlots.clear();
+    }
+
+    matchPairLegs(runCache, streamCache, record);
+
+    // every leg enters the denominator of each selected path and the numerators of the filters it has been matched to
+    const size_t nPathSlots = runCache->hltPaths.size();
+    for (size_t i = 0; (i < streamCache->legs.size()) && efficiencyHistograms_.enabled(); ++i) {
+        const PairLeg& leg = streamCache->legs[i];
+        const int legIndex = efficiencyLegIndices_[leg.type];
+        if (legIndex < 0) {
+            continue;
+        }
+        for (size_t pathSlot = 0; pathSlot < nPathSlots; ++pathSlot) {
+            streamCache->efficiencyHistograms.fill(runCache->efficiencyDenominatorSlots[pathSlot], legIndex, leg.pt, leg.eta, leg.decayMode, record.genWeight);
+            const vector<size_t>& filterSlots = runCache->efficiencyFilterSlots[pathSlot];
+            const uint64_t legPathMask = streamCache->legPathMasks[i * nPathSlots + pathSlot];
+            for (size_t j = 0; (j < filterSlots.size()) && (j < 64); ++j) {
+                if ((legPathMask >> j) & 1) {
+                    streamCache->efficiencyHistograms.fill(filterSlots[j], legIndex, leg.pt, leg.eta, leg.decayMode, record.genWeight);
+                }
+            }
+        }
+    }
+
+    if (reducedPrecision_) {
+        record.reducePrecision();
+    }
+
+    // hand the records over to the writer once the batch is full, in deterministic order the stream keeps all records of
+    // the luminosity block until its end
+    streamCache->nRecords++;
+    if (streamCache->nRecords == streamCache->records.size()) {
+        if (deterministicOrder_ && writeEvents_) {
+            streamCache->records.resize(streamCache->records.size() + batchSize_);
+        } else {
+            flushStream(streamCache);
+        }
+    }
+}
+
+
+void TauTriggerNtuplizer::endStream(StreamID streamID) const {
+    TauTriggerStreamCache* streamCache = this->streamCache(streamID);
+    flushStream(streamCache);
+
+    if (efficiencyHistograms_.enabled()) {
+        lock_guard<mutex> lock(efficiencyMutex_);
+        mergedEfficiencyHistograms_.merge(streamCache->efficiencyHistograms);
+    }
+}
+
+
+shared_ptr<TauTriggerLumiSummary> TauTriggerNtuplizer::globalBeginLuminosityBlockSummary(const LuminosityBlock& lumi, const EventSetup& setup) const {
+    return make_shared<TauTriggerLumiSummary>();
+}
+
+
+// called by the framework for one stream at a time
+void TauTriggerNtuplizer::streamEndLuminosityBlockSummary(StreamID streamID, const LuminosityBlock& lumi, const EventSetup& setup, TauTriggerLumiSummary* summary) const {
+    if (!(deterministicOrder_ && writeEvents_)) {
+        return;
     }
+    TauTriggerStreamCache* streamCache = this->streamCache(streamID);
+    summary->insert(
+        summary->end(),
+        make_move_iterator(streamCache->records.begin()),
+        make_move_iterator(streamCache->records.begin() + streamCache->nRecords)
+    );
+    streamCache->nRecords = 0;
+}
+
+
+void TauTriggerNtuplizer::globalEndLuminosityBlockSummary(const LuminosityBlock& lumi, const EventSetup& setup, TauTriggerLumiSummary* summary) const {
+    if (!(deterministicOrder_ && writeEvents_)) {
+        return;
+    }
+    eventsWriter_.write(*summary, summary->size());
+    summary->clear();
+}
+
+
+void TauTriggerNtuplizer::endJob() {
+    lock_guard<mutex> lock(util::getTFileServiceMutex());
+    if (efficiencyHistograms_.enabled()) {
+        TFileDirectory efficiencyDirectory = fs_->mkdir("efficiency");
+        mergedEfficiencyHistograms_.write(efficiencyDirectory);
+    }
+    LogInfo("TauTriggerNtuplizer") << writeProfile_.report(eventsTree_);
+    LogInfo("TauTriggerNtuplizer") << writeProfile_.report(hltTree_);
+    LogInfo("TauTriggerNtuplizer") << writeProfile_.report(hltModuleLabelsTree_);
+}
+
+
+void TauTriggerNtuplizer::flushStream(TauTriggerStreamCache* streamCache) const {
+    // without event rows the records are only used for the efficiency histograms
+    if (writeEvents_) {
+        eventsWriter_.write(streamCache->records, streamCache->nRecords);
+    }
+    streamCache->nRecords = 0;
+}
+
 
-    eventsTree_->Fill();
+const bool TauTriggerNtuplizer::isSelectedTriggerObjectType(const int& trigObjType) const {
+    // an empty selection keeps all trigger object types
+    if (triggerObjectTypes_.empty()) {
+        return true;
+    }
+    return find(triggerObjectTypes_.begin(), triggerObjectTypes_.end(), trigObjType) != triggerObjectTypes_.end();
 }
 
 
-void TauTriggerNtuplizer::endJob() {}
+void TauTriggerNtuplizer::fillPairLeg(TauTriggerStreamCache* streamCache, TauTriggerEventRecord& record, const PairLegType& type, const reco::Candidate& candidate) const {
+    int index = 0;
+    double decayMode = -1.;
+    if (type == electronLeg) {
+        index = record.pairElectrons.size();
+        record.pairElectrons.push_back(candidate);
+    } else if (type == muonLeg) {
+        index = record.pairMuons.size();
+        record.pairMuons.push_back(candidate);
+    } else {
+        index = record.pairTaus.size();
+        record.pairTaus.push_back(candidate);
+        const Tau* tau = dynamic_cast<const Tau*>(&candidate);
+        decayMode = tau ? static_cast<double>(tau->decayMode()) : -1.;
+    }
+    streamCache->legs.push_back(PairLeg{type, index, candidate.pt(), candidate.eta(), candidate.phi(), decayMode});
+}
+
+
+void TauTriggerNtuplizer::matchPairLegs(const TauTriggerRunCache* runCache, TauTriggerStreamCache* streamCache, TauTriggerEventRecord& record) const {
+    const size_t nPathSlots = runCache->hltPaths.size();
+    streamCache->matcher.build();
+    streamCache->legPathMasks.assign(streamCache->legs.size() * nPathSlots, 0);
+
+    for (size_t i = 0; i < streamCache->legs.size(); ++i) {
+        const PairLeg& leg = streamCache->legs[i];
+        streamCache->matcher.match(leg.eta, leg.phi, streamCache->matches);
+
+        // the best match is the closest stored object, the filters of all objects in the cone count for the leg
+        int bestObjectIndex = -1;
+        double bestDeltaR2 = 0.;
+        for (const size_t& match : streamCache->matches) {
+            const int objectIndex = streamCache->matcherObjectIndices[match];
+            const double deltaR2 = streamCache->matcher.deltaR2(match, leg.eta, leg.phi);
+            if ((objectIndex >= 0) && ((bestObjectIndex < 0) || (deltaR2 < bestDeltaR2))) {
+                bestObjectIndex = objectIndex;
+                bestDeltaR2 = deltaR2;
+            }
+            for (size_t k = streamCache->matcherMaskOffsets[match]; k < streamCache->matcherMaskOffsets[match + 1]; ++k) {
+                const pair<size_t, uint64_t>& pathMask = streamCache->matcherMasks[k];
+                streamCache->legPathMasks[i * nPathSlots + pathMask.first] |= pathMask.second;
+            }
+        }
 
+        if (leg.type == electronLeg) {
+            record.pairElectronTriggerObjectIndex.push_back(bestObjectIndex);
+        } else if (leg.type == muonLeg) {
+            record.pairMuonTriggerObjectIndex.push_back(bestObjectIndex);
+        } else {
+            record.pairTauTriggerObjectIndex.push_back(bestObjectIndex);
+        }
 
-const bool TauTriggerNtuplizer::isSelectedHLTPath(const string& path) {
-    for (const string& name : hltPathList_) {
-        // the selected HLT path name can differ from the actual name by a version suffix
-        // make a regex matching in order to identify whether we have a selected HLT path here
-        char buffer[1024];
-        snprintf(buffer, 1024, "^%s_v\\d+$", name.c_str());
-        string selPathPattern(buffer);
-        regex selPathRegex(selPathPattern);
-        smatch match;
-        if (regex_match(path, match, selPathRegex)) {
-            return true;
+        // the deepest filter reached is the last saveTags filter of the path that has been matched
+        for (size_t pathSlot = 0; pathSlot < nPathSlots; ++pathSlot) {
+            const uint64_t legPathMask = streamCache->legPathMasks[i * nPathSlots + pathSlot];
+            if (legPathMask == 0) {
+                continue;
+            }
+            const int deepestSaveTagsIndex = 63 - __builtin_clzll(legPathMask);
+            record.pairLegPathLegType.push_back(leg.type);
+            record.pairLegPathLegIndex.push_back(leg.index);
+            record.pairLegPathHLTPathIndex.push_back(runCache->hltPaths[pathSlot]->index());
+            record.pairLegPathDeepestModule.push_back(runCache->hltPaths[pathSlot]->moduleIndicesSaveTags().at(deepestSaveTagsIndex));
+            record.pairLegPathMask.push_back(legPathMask);
         }
     }
+}
+
 
-    // if no match has been found, this HLT path is not in the list of selected HLT paths
-    return false;
+const int TauTriggerNtuplizer::getModuleLabelId(const string& moduleLabel, vector<TauTriggerModuleLabelRecord>& moduleLabelRecords) const {
+    // requires the lock of hltMenuMutex_, labels that are seen for the first time are added to the records
+    const unordered_map<string, int>::const_iterator it = hltModuleLabelIds_.find(moduleLabel);
+    if (it != hltModuleLabelIds_.end()) {
+        return it->second;
+    }
+    const int moduleLabelId = hltModuleLabelIds_.size();
+    hltModuleLabelIds_[moduleLabel] = moduleLabelId;
+    moduleLabelRecords.push_back(TauTriggerModuleLabelRecord());
+    moduleLabelRecords.back().hltModuleLabelId = moduleLabelId;
+    moduleLabelRecords.back().hltModuleLabel = moduleLabel;
+    return moduleLabelId;
 }
 
 
@@ -499,7 +690,7 @@ const bool TauTriggerNtuplizer::isSelectedHLTPath(const string& path) {
 // dummy implementations of EDAnalyzer methods that are not used
 //
 
-void TauTriggerNtuplizer::endRun(const Run& run, const EventSetup& setup) {}
+void TauTriggerNtuplizer::globalEndRun(const Run& run, const EventSetup& setup) const {}
 
 
 //define this as a plug-in
@@ -1,7 +1,15 @@
 import FWCore.ParameterSet.Config as cms
 
 
-genWeightNtuplizer = cms.EDAnalyzer(
+genWeightNtuplizer = cms.EDProducer(
     "GenWeightNtuplizer",
     generator=cms.InputTag("generator"),
+    lheEventProduct=cms.InputTag("externalLHEProducer"),
+    writeEvents=cms.untracked.bool(False),
+    lheWeights=cms.untracked.bool(False),
+    psWeights=cms.untracked.bool(False),
+    writeProfile=cms.untracked.PSet(
+        profile=cms.untracked.string("default"),
+        branchSettings=cms.untracked.VPSet(),
+    ),
 )
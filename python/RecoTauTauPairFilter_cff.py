@@ -29,88 +29,47 @@ slimmedElectronsWithUserData = cms.EDProducer(
 )
 
 
-# select good electrons for tau tau pair selection
-slimmedElectronsForTauTauPair = cms.EDFilter(
-    "PATElectronSelector",
-    src=cms.InputTag("slimmedElectronsWithUserData"),
-    cut=cms.string(
-        "(pt > 20) && (abs(eta) < 2.5)"
-        + ' && (abs(dB("PV2D")) < 0.045) && (abs(dB("PVDZ")) < 0.2)'
-        + ' && (userFloat("PFIsoAll")/pt < 0.15)'
-        + ' && (electronID("mvaEleID-Fall17-noIso-V1-wp90") > 0.5)'
+# preselect the signal and veto electrons, muons and taus for the tau tau pair selection
+recoTauTauPreselection = cms.EDProducer(
+    "RecoTauTauPreselectionProducer",
+    electrons=cms.InputTag("slimmedElectronsWithUserData"),
+    muons=cms.InputTag("slimmedMuons"),
+    taus=cms.InputTag("slimmedTausWithDeepTau2p1"),
+    electronSelection=cms.PSet(
+        ptMin=cms.double(20.),
+        vetoPtMin=cms.double(10.),
+        etaMax=cms.double(2.5),
+        dxyMax=cms.double(0.045),
+        dzMax=cms.double(0.2),
+        relIsoMax=cms.double(0.15),
+        vetoRelIsoMax=cms.double(0.3),
+        electronID=cms.string("mvaEleID-Fall17-noIso-V1-wp90"),
     ),
-)
-
-
-# select veto electrons for tau tau pair selection
-vetoElectronsForTauTauPair = cms.EDFilter(
-    "PATElectronSelector",
-    src=cms.InputTag("slimmedElectronsWithUserData"),
-    cut=cms.string(
-        "(pt > 10) && (abs(eta) < 2.5)"
-        + ' && (abs(dB("PV2D")) < 0.045) && (abs(dB("PVDZ")) < 0.2)'
-        + ' && (userFloat("PFIsoAll")/pt < 0.3)'
-        + ' && (electronID("mvaEleID-Fall17-noIso-V1-wp90") > 0.5)'
-    ),
-)
-
-
-# select good muons for tau tau pair selection
-slimmedMuonsForTauTauPair = cms.EDFilter(
-    "PATMuonSelector",
-    src=cms.InputTag("slimmedMuons"),
-    cut=cms.string(
-        "(pt > 20) && (abs(eta) < 2.4)"
-        + ' && (abs(dB("PV2D")) < 0.045) && (abs(dB("PVDZ")) < 0.2)'
-        + " && ((pfIsolationR04().sumChargedHadronPt + max(pfIsolationR04().sumNeutralHadronEt + pfIsolationR04().sumPhotonEt - 0.5 * pfIsolationR04().sumPUPt, 0.0)) / pt() < 0.15)"
-        + " && (isMediumMuon)"
-    ),
-)
-
-
-# select veto muons for tau tau pair selection
-vetoMuonsForTauTauPair = cms.EDFilter(
-    "PATMuonSelector",
-    src=cms.InputTag("slimmedMuons"),
-    cut=cms.string(
-        "(pt > 10) && (abs(eta) < 2.4)"
-        + ' && (abs(dB("PV2D")) < 0.045) && (abs(dB("PVDZ")) < 0.2)'
-        + " && ((pfIsolationR04().sumChargedHadronPt + max(pfIsolationR04().sumNeutralHadronEt + pfIsolationR04().sumPhotonEt - 0.5 * pfIsolationR04().sumPUPt, 0.0)) / pt() < 0.3)"
-        + " && (isMediumMuon)"
+    muonSelection=cms.PSet(
+        ptMin=cms.double(20.),
+        vetoPtMin=cms.double(10.),
+        etaMax=cms.double(2.4),
+        dxyMax=cms.double(0.045),
+        dzMax=cms.double(0.2),
+        relIsoMax=cms.double(0.15),
+        vetoRelIsoMax=cms.double(0.3),
     ),
-)
-
-# select good taus for tau tau pair selection
-slimmedTausForTauTauPair = cms.EDFilter(
-    "PATTauSelector",
-    src=cms.InputTag("slimmedTausWithDeepTau2p1"),
-    cut=cms.string(
-        "(pt > 20) && (eta < 2.5)"
-        + " && ((decayMode == 0) || (decayMode == 1) || (decayMode == 10) || (decayMode == 11))"
-        + ' && (tauID("byVVLooseDeepTau2017v2p1VSe") > 0.5)'
-        + ' && (tauID("byVLooseDeepTau2017v2p1VSmu") > 0.5)'
-        + ' && (tauID("byMediumDeepTau2017v2p1VSjet") > 0.5)'
+    tauSelection=cms.PSet(
+        ptMin=cms.double(20.),
+        etaMax=cms.double(2.5),
+        decayModes=cms.vint32(0, 1, 10, 11),
     ),
 )
 
 
-# the producer for selecting the tau tau pair final state
-recoTauTauPairProducer = cms.EDProducer(
-    "RecoTauTauPairProducer",
-    electrons=cms.InputTag("slimmedElectronsForTauTauPair"),
-    muons=cms.InputTag("slimmedMuonsForTauTauPair"),
-    taus=cms.InputTag("slimmedTausForTauTauPair"),
-    vetoElectrons=cms.InputTag("vetoElectronsForTauTauPair"),
-    vetoMuons=cms.InputTag("vetoMuonsForTauTauPair"),
-)
-
-
-# the filter for all events with a valid tau tau pair
+# the filter that selects the tau tau pair and keeps all events with a valid pair
 recoTauTauPairFilter = cms.EDFilter(
     "RecoTauTauPairFilter",
-    pairElectrons=cms.InputTag("recoTauTauPairProducer", "pairElectrons"),
-    pairMuons=cms.InputTag("recoTauTauPairProducer", "pairMuons"),
-    pairTaus=cms.InputTag("recoTauTauPairProducer", "pairTaus"),
+    electrons=cms.InputTag("slimmedElectronsWithUserData"),
+    muons=cms.InputTag("slimmedMuons"),
+    taus=cms.InputTag("slimmedTausWithDeepTau2p1"),
+    preselection=cms.InputTag("recoTauTauPreselection"),
+    storeLegCopies=cms.untracked.bool(False),
     filter=cms.bool(True),
 )
 
@@ -118,11 +77,6 @@ recoTauTauPairFilter = cms.EDFilter(
 recoTauTauPairFilterSequence = cms.Sequence(
     isoForEle
     + slimmedElectronsWithUserData
-    + slimmedElectronsForTauTauPair
-    + vetoElectronsForTauTauPair
-    + slimmedMuonsForTauTauPair
-    + vetoMuonsForTauTauPair
-    + slimmedTausForTauTauPair
-    + recoTauTauPairProducer
+    + recoTauTauPreselection
     + recoTauTauPairFilter
 )
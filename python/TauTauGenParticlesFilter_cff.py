@@ -1,18 +1,27 @@
 import FWCore.ParameterSet.Config as cms
 
 
+genDecayTreeProducer = cms.EDProducer(
+    "GenDecayTreeProducer",
+    genParticles=cms.InputTag("prunedGenParticles"),
+)
+
+
 tauTauGenParticlesProducer = cms.EDProducer(
     "TauTauGenParticlesProducer",
     genParticles=cms.InputTag("prunedGenParticles"),
+    genDecayTree=cms.InputTag("genDecayTreeProducer"),
+    # required by writeGenParticles of tauTriggerNtuplizer
+    storeDaughters=cms.untracked.bool(False),
 )
 
 
 tauTauGenParticlesFilter = cms.EDFilter(
     "TauTauGenParticlesFilter",
-    tauTauGenParticles=cms.InputTag("tauTauGenParticlesProducer", "tauTauGenParticles"),
+    genTauTauFinalState=cms.InputTag("tauTauGenParticlesProducer"),
     filter=cms.bool(True),
 )
 
 tauTauGenParticlesFilterSequence = cms.Sequence(
-    tauTauGenParticlesProducer + tauTauGenParticlesFilter
+    genDecayTreeProducer + tauTauGenParticlesProducer + tauTauGenParticlesFilter
 )
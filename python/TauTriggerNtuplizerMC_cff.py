@@ -12,15 +12,35 @@ patTriggerUnpacker = cms.EDProducer(
 tauTriggerNtuplizer = cms.EDAnalyzer(
     "TauTriggerNtuplizer",
     hltPathList=cms.untracked.vstring([]),
-    pairElectrons=cms.InputTag("recoTauTauPairProducer", "pairElectrons"),
-    pairMuons=cms.InputTag("recoTauTauPairProducer", "pairMuons"),
-    pairTaus=cms.InputTag("recoTauTauPairProducer", "pairTaus"),
+    tauTauPair=cms.InputTag("recoTauTauPairFilter"),
     tauTauGenParticles=cms.InputTag("tauTauGenParticlesProducer", "tauTauGenParticles"),
+    genTauTauFinalState=cms.InputTag("tauTauGenParticlesProducer"),
     triggerResults=cms.InputTag("TriggerResults", "", "HLT"),
     triggerObjects=cms.InputTag("patTriggerUnpacker"),
     generator=cms.InputTag("generator"),
     isMC=cms.untracked.bool(True),
     isEmb=cms.untracked.bool(False),
+    # requires storeDaughters of tauTauGenParticlesProducer
+    writeGenParticles=cms.untracked.bool(False),
+    triggerObjectTypes=cms.untracked.vint32([]),
+    batchSize=cms.untracked.uint32(100),
+    # sort the rows by run, lumi and event within each luminosity block, not across blocks
+    deterministicOrder=cms.untracked.bool(False),
+    outputLayout=cms.untracked.string("vector"),
+    writeEvents=cms.untracked.bool(True),
+    reducedPrecision=cms.untracked.bool(False),
+    triggerMatchDeltaR=cms.untracked.double(0.5),
+    efficiencyHistograms=cms.untracked.PSet(
+        enabled=cms.untracked.bool(False),
+        legs=cms.untracked.vstring(["tau"]),
+        ptBins=cms.untracked.vdouble([20., 25., 30., 35., 40., 50., 60., 80., 100., 150., 200.]),
+        etaBins=cms.untracked.vdouble([-2.5, -1.5, 0., 1.5, 2.5]),
+        decayModeBins=cms.untracked.vdouble([-1.5, -0.5, 0.5, 1.5, 2.5, 9.5, 10.5, 11.5]),
+    ),
+    writeProfile=cms.untracked.PSet(
+        profile=cms.untracked.string("default"),
+        branchSettings=cms.untracked.VPSet(),
+    ),
 )
 
 
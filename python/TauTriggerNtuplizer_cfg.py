@@ -16,7 +16,22 @@ options.register(
     [],
     VarParsing.VarParsing.multiplicity.list,
     VarParsing.VarParsing.varType.string,
-    "list of HLT paths, which are regarded when processing these events",
+    "list of HLT paths without version suffix, which are regarded when processing these events; the wildcards '*' and '?' are supported",
+)
+options.register(
+    "genWeightSummaryFile",
+    "",
+    VarParsing.VarParsing.multiplicity.singleton,
+    VarParsing.VarParsing.varType.string,
+    "optional EDM file that keeps the per-lumi and per-run generator weight summaries, which merge across jobs without an event loop; by default only the 'genWeightLumis' and 'genWeightRuns' trees carry the summaries",
+)
+
+options.register(
+    "writeGenParticles",
+    False,
+    VarParsing.VarParsing.multiplicity.singleton,
+    VarParsing.VarParsing.varType.bool,
+    "write the generator-level tau pair and the daughters of both taus to the event tree; sets both 'storeDaughters' of the generator-level pair producer and 'writeGenParticles' of the ntuplizer",
 )
 
 # parse and validate the arguments
@@ -92,7 +107,13 @@ elif dataset_type == "mc":
 # initialize the HLT path argument of the ntuplizer correctly
 process.tauTriggerNtuplizer.hltPathList = cms.untracked.vstring(hlt_paths)
 
-# service that provides the output file
+# the ntuplizer can only write the daughters of the generator-level pair if its producer stores them
+process.tauTauGenParticlesProducer.storeDaughters = cms.untracked.bool(options.writeGenParticles)
+process.tauTriggerNtuplizer.writeGenParticles = cms.untracked.bool(options.writeGenParticles)
+
+# service that provides the output file; tauTriggerNtuplizer and genWeightNtuplizer are global modules that serialize
+# their writes with a mutex of this package instead of the "TFileService" shared resource, so no module of another
+# package that writes through the TFileService may be added to this process
 process.TFileService = cms.Service(
     "TFileService",
     fileName=cms.string(options.outputFile),
@@ -106,3 +127,15 @@ process.p = cms.Path(
     + process.recoTauTauPairFilterSequence
     + process.tauTriggerNtuplizerSequence
 )
+
+# EDM output of the generator weight summaries, all event products are dropped
+if options.genWeightSummaryFile:
+    process.genWeightSummaryOutput = cms.OutputModule(
+        "PoolOutputModule",
+        fileName=cms.untracked.string(options.genWeightSummaryFile),
+        outputCommands=cms.untracked.vstring(
+            "drop *",
+            "keep *_genWeightNtuplizer_*_*",
+        ),
+    )
+    process.genWeightSummaryOutputPath = cms.EndPath(process.genWeightSummaryOutput)
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <TArrayD.h>
+#include <TH3D.h>
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/FilterEfficiencyHistograms.h"
+
+using namespace std;
+
+
+EfficiencyCounts::EfficiencyCounts() {
+    binning_ = nullptr;
+    sumWeights_ = vector<double>();
+    sumWeights2_ = vector<double>();
+}
+
+
+EfficiencyCounts::EfficiencyCounts(const shared_ptr<const EfficiencyBinning>& binning) {
+    binning_ = binning;
+    const size_t nBins = (binning_->ptBins.size() + 1) * (binning_->etaBins.size() + 1) * (binning_->decayModeBins.size() + 1);
+    sumWeights_ = vector<double>(nBins, 0.);
+    sumWeights2_ = vector<double>(nBins, 0.);
+}
+
+
+void EfficiencyCounts::fill(const double& pt, const double& eta, const double& decayMode, const double& weight) {
+    // global bin numbering of a TH3, n edges give n - 1 bins plus under- and overflow
+    const size_t nPtBins = binning_->ptBins.size() + 1;
+    const size_t nEtaBins = binning_->etaBins.size() + 1;
+    const size_t bin = findBin(binning_->ptBins, pt)
+        + nPtBins * (findBin(binning_->etaBins, eta) + nEtaBins * findBin(binning_->decayModeBins, decayMode));
+    sumWeights_[bin] += weight;
+    sumWeights2_[bin] += weight * weight;
+}
+
+
+void EfficiencyCounts::add(const EfficiencyCounts& counts) {
+    if (sumWeights_.empty()) {
+        *this = counts;
+        return;
+    }
+    if (counts.sumWeights_.size() != sumWeights_.size()) {
+        throw logic_error("EfficiencyCounts: cannot add counts with a different binning");
+    }
+    for (size_t i = 0; i < sumWeights_.size(); ++i) {
+        sumWeights_[i] += counts.sumWeights_[i];
+        sumWeights2_[i] += counts.sumWeights2_[i];
+    }
+}
+
+
+const vector<double>& EfficiencyCounts::sumWeights() const {
+    return sumWeights_;
+}
+
+
+const vector<double>& EfficiencyCounts::sumWeights2() const {
+    return sumWeights2_;
+}
+
+
+const size_t EfficiencyCounts::findBin(const vector<double>& edges, const double& value) {
+    // 0 is the underflow and edges.size() the overflow bin, as in TAxis::FindBin
+    return upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+}
+
+
+FilterEfficiencyHistograms::FilterEfficiencyHistograms() {
+    enabled_ = false;
+    legs_ = vector<string>();
+    binning_ = make_shared<const EfficiencyBinning>();
+    keyTable_ = make_shared<EfficiencyKeyTable>();
+    counts_ = vector<vector<EfficiencyCounts>>();
+}
+
+
+FilterEfficiencyHistograms::FilterEfficiencyHistograms(const edm::ParameterSet& pset) {
+    enabled_ = pset.getUntrackedParameter<bool>("enabled", false);
+    legs_ = pset.getUntrackedParameter<vector<string>>("legs", vector<string>({"tau"}));
+    for (const string& leg : legs_) {
+        if ((leg != "electron") && (leg != "muon") && (leg != "tau")) {
+            throw cms::Exception("Configuration") << "FilterEfficiencyHistograms: unknown leg type '" << leg << "', must be 'electron', 'muon' or 'tau'";
+        }
+    }
+
+    EfficiencyBinning binning = EfficiencyBinning{
+        pset.getUntrackedParameter<vector<double>>("ptBins", vector<double>({20., 25., 30., 35., 40., 50., 60., 80., 100., 150., 200.})),
+        pset.getUntrackedParameter<vector<double>>("etaBins", vector<double>({-2.5, -1.5, 0., 1.5, 2.5})),
+        pset.getUntrackedParameter<vector<double>>("decayModeBins", vector<double>({-1.5, -0.5, 0.5, 1.5, 2.5, 9.5, 10.5, 11.5}))
+    };
+    for (const vector<double>* edges : {&binning.ptBins, &binning.etaBins, &binning.decayModeBins}) {
+        if ((edges->size() < 2) || !is_sorted(edges->begin(), edges->end())) {
+            throw cms::Exception("Configuration") << "FilterEfficiencyHistograms: bin edges must be at least two values in increasing order";
+        }
+    }
+    binning_ = make_shared<const EfficiencyBinning>(binning);
+    keyTable_ = make_shared<EfficiencyKeyTable>();
+    counts_ = vector<vector<EfficiencyCounts>>();
+}
+
+
+const bool FilterEfficiencyHistograms::enabled() const {
+    return enabled_;
+}
+
+
+const vector<string>& FilterEfficiencyHistograms::legs() const {
+    return legs_;
+}
+
+
+const int FilterEfficiencyHistograms::legIndex(const string& leg) const {
+    const vector<string>::const_iterator it = find(legs_.begin(), legs_.end(), leg);
+    return it == legs_.end() ? -1 : static_cast<int>(it - legs_.begin());
+}
+
+
+// thread-safe: the key table is shared by the copies that are filled by the streams
+const size_t FilterEfficiencyHistograms::slot(const string& key) const {
+    lock_guard<mutex> lock(keyTable_->keysMutex);
+    const pair<unordered_map<string, size_t>::iterator, bool> entry = keyTable_->slots.emplace(key, keyTable_->keys.size());
+    if (entry.second) {
+        keyTable_->keys.push_back(key);
+    }
+    return entry.first->second;
+}
+
+
+void FilterEfficiencyHistograms::fill(const size_t& slot, const size_t& legIndex, const double& pt, const double& eta, const double& decayMode, const double& weight) {
+    // the counts of a slot are only allocated once the slot is filled
+    if (slot >= counts_.size()) {
+        counts_.resize(slot + 1);
+    }
+    vector<EfficiencyCounts>& counts = counts_[slot];
+    if (counts.empty()) {
+        counts = vector<EfficiencyCounts>(legs_.size(), EfficiencyCounts(binning_));
+    }
+    counts[legIndex].fill(pt, eta, decayMode, weight);
+}
+
+
+void FilterEfficiencyHistograms::merge(const FilterEfficiencyHistograms& histograms) {
+    if (histograms.keyTable_ != keyTable_) {
+        throw logic_error("FilterEfficiencyHistograms: cannot merge counts with different key tables");
+    }
+    if (histograms.counts_.size() > counts_.size()) {
+        counts_.resize(histograms.counts_.size());
+    }
+    for (size_t slot = 0; slot < histograms.counts_.size(); ++slot) {
+        const vector<EfficiencyCounts>& otherCounts = histograms.counts_[slot];
+        vector<EfficiencyCounts>& counts = counts_[slot];
+        if (counts.empty()) {
+            counts = otherCounts;
+            continue;
+        }
+        for (size_t i = 0; i < otherCounts.size(); ++i) {
+            counts[i].add(otherCounts[i]);
+        }
+    }
+}
+
+
+void FilterEfficiencyHistograms::write(TFileDirectory& directory) const {
+    // group the counts by path, so that every path directory is created once and the output does not depend on the
+    // order of the hash map
+    map<string, map<string, const vector<EfficiencyCounts>*>> countsByPath;
+    for (size_t slot = 0; slot < counts_.size(); ++slot) {
+        if (counts_[slot].empty()) {
+            continue;
+        }
+        const string& key = keyTable_->keys.at(slot);
+        const size_t separator = key.find('/');
+        countsByPath[key.substr(0, separator)][key.substr(separator + 1)] = &counts_[slot];
+    }
+
+    const EfficiencyBinning& binning = *binning_;
+    for (const pair<const string, map<string, const vector<EfficiencyCounts>*>>& pathEntry : countsByPath) {
+        TFileDirectory pathDirectory = directory.mkdir(pathEntry.first);
+        for (const pair<const string, const vector<EfficiencyCounts>*>& entry : pathEntry.second) {
+            for (size_t i = 0; i < legs_.size(); ++i) {
+                const string name = legs_[i] + "_" + entry.first;
+                TH3D* histogram = pathDirectory.make<TH3D>(
+                    name.c_str(), (name + ";p_{T} (GeV);#eta;decay mode").c_str(),
+                    binning.ptBins.size() - 1, binning.ptBins.data(),
+                    binning.etaBins.size() - 1, binning.etaBins.data(),
+                    binning.decayModeBins.size() - 1, binning.decayModeBins.data()
+                );
+                histogram->Sumw2();
+
+                const EfficiencyCounts& counts = entry.second->at(i);
+                TArrayD* sumWeights2 = histogram->GetSumw2();
+                for (size_t bin = 0; bin < counts.sumWeights().size(); ++bin) {
+                    histogram->SetBinContent(bin, counts.sumWeights()[bin]);
+                    sumWeights2->SetAt(counts.sumWeights2()[bin], bin);
+                }
+                histogram->ResetStats();
+            }
+        }
+    }
+}
+
+
+const string FilterEfficiencyHistograms::denominatorKey(const string& pathName) {
+    return pathName + "/denominator";
+}
+
+
+const string FilterEfficiencyHistograms::filterKey(const string& pathName, const string& filterLabel) {
+    return pathName + "/" + filterLabel;
+}
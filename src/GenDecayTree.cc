@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
+
+using namespace reco;
+using namespace std;
+
+
+namespace tautau_selection_gen {
+
+
+GenIndexRange::GenIndexRange(const uint32_t* begin, const uint32_t* end) {
+    begin_ = begin;
+    end_ = end;
+}
+
+
+const uint32_t* GenIndexRange::begin() const {
+    return begin_;
+}
+
+
+const uint32_t* GenIndexRange::end() const {
+    return end_;
+}
+
+
+const size_t GenIndexRange::size() const {
+    return end_ - begin_;
+}
+
+
+const uint32_t GenIndexRange::operator[](const size_t& i) const {
+    return begin_[i];
+}
+
+
+GenDecayTree::GenDecayTree() {
+    pdgIds_ = vector<int>();
+    charges_ = vector<int>();
+    statusFlags_ = vector<uint16_t>();
+    motherOffsets_ = vector<uint32_t>(1, 0);
+    motherIndices_ = vector<uint32_t>();
+    daughterOffsets_ = vector<uint32_t>(1, 0);
+    daughterIndices_ = vector<uint32_t>();
+    lastCopies_ = vector<uint32_t>();
+}
+
+
+GenDecayTree::GenDecayTree(const vector<GenParticle>& genParticles) : GenDecayTree() {
+    const size_t n = genParticles.size();
+    pdgIds_.reserve(n);
+    charges_.reserve(n);
+    statusFlags_.reserve(n);
+    motherOffsets_.reserve(n + 1);
+    daughterOffsets_.reserve(n + 1);
+
+    // the mother and daughter references of the record point into the record itself, their keys are the indices
+    for (const GenParticle& genParticle : genParticles) {
+        pdgIds_.push_back(genParticle.pdgId());
+        charges_.push_back(genParticle.charge());
+        statusFlags_.push_back(static_cast<uint16_t>(genParticle.statusFlags().flags_.to_ulong()));
+        for (const GenParticleRef& mother : genParticle.motherRefVector()) {
+            if (mother.key() >= n) {
+                throw runtime_error("GenDecayTree: mother reference does not point into the generator record");
+            }
+            motherIndices_.push_back(mother.key());
+        }
+        motherOffsets_.push_back(motherIndices_.size());
+        for (const GenParticleRef& daughter : genParticle.daughterRefVector()) {
+            if (daughter.key() >= n) {
+                throw runtime_error("GenDecayTree: daughter reference does not point into the generator record");
+            }
+            daughterIndices_.push_back(daughter.key());
+        }
+        daughterOffsets_.push_back(daughterIndices_.size());
+    }
+
+    // follow the copies of each particle, all particles on the way share the last copy and are not walked again
+    const uint32_t unresolved = UINT32_MAX;
+    lastCopies_ = vector<uint32_t>(n, unresolved);
+    vector<uint32_t> chain = vector<uint32_t>();
+    for (uint32_t i = 0; i < n; ++i) {
+        chain.clear();
+        uint32_t copy = i;
+        while ((lastCopies_[copy] == unresolved) && !hasStatusFlag(copy, GenStatusFlags::kIsLastCopy)) {
+            chain.push_back(copy);
+            uint32_t nextCopy = copy;
+            for (const uint32_t daughter : daughters(copy)) {
+                if (abs(pdgIds_[daughter]) == abs(pdgIds_[copy])) {
+                    nextCopy = daughter;
+                    break;
+                }
+            }
+            // stop at particles without a further copy and at malformed records with cycles
+            if ((nextCopy == copy) || (chain.size() > n)) {
+                break;
+            }
+            copy = nextCopy;
+        }
+        const uint32_t lastCopy = (lastCopies_[copy] == unresolved) ? copy : lastCopies_[copy];
+        for (const uint32_t particle : chain) {
+            lastCopies_[particle] = lastCopy;
+        }
+        lastCopies_[copy] = lastCopy;
+    }
+}
+
+
+const size_t GenDecayTree::size() const {
+    return pdgIds_.size();
+}
+
+
+const vector<int>& GenDecayTree::pdgIds() const {
+    return pdgIds_;
+}
+
+
+const vector<int>& GenDecayTree::charges() const {
+    return charges_;
+}
+
+
+const vector<uint16_t>& GenDecayTree::statusFlags() const {
+    return statusFlags_;
+}
+
+
+const bool GenDecayTree::hasStatusFlag(const size_t& i, const GenStatusFlags::StatusBits& bit) const {
+    return (statusFlags_[i] >> bit) & 1;
+}
+
+
+const GenIndexRange GenDecayTree::mothers(const size_t& i) const {
+    return GenIndexRange(motherIndices_.data() + motherOffsets_[i], motherIndices_.data() + motherOffsets_[i + 1]);
+}
+
+
+const GenIndexRange GenDecayTree::daughters(const size_t& i) const {
+    return GenIndexRange(daughterIndices_.data() + daughterOffsets_[i], daughterIndices_.data() + daughterOffsets_[i + 1]);
+}
+
+
+const uint32_t GenDecayTree::lastCopy(const size_t& i) const {
+    return lastCopies_[i];
+}
+
+
+}; // end namespace tautau_selection_gen
@@ -0,0 +1,36 @@
+#include "TauAnalysis/TauTriggerNtuples/interface/GenTauTauFinalState.h"
+
+
+namespace tautau_selection_gen {
+
+
+GenTauTauFinalState::GenTauTauFinalState() {
+    finalState_ = HZGammaFinalState::unknown;
+    firstTau_ = GenTauDecay{TauFinalState::tauToUnknown, -1, math::XYZTLorentzVector(), math::XYZTLorentzVector()};
+    secondTau_ = GenTauDecay{TauFinalState::tauToUnknown, -1, math::XYZTLorentzVector(), math::XYZTLorentzVector()};
+}
+
+
+GenTauTauFinalState::GenTauTauFinalState(const HZGammaFinalState& finalState, const GenTauDecay& firstTau, const GenTauDecay& secondTau) {
+    finalState_ = finalState;
+    firstTau_ = firstTau;
+    secondTau_ = secondTau;
+}
+
+
+const HZGammaFinalState GenTauTauFinalState::finalState() const {
+    return static_cast<HZGammaFinalState>(finalState_);
+}
+
+
+const GenTauDecay& GenTauTauFinalState::firstTau() const {
+    return firstTau_;
+}
+
+
+const GenTauDecay& GenTauTauFinalState::secondTau() const {
+    return secondTau_;
+}
+
+
+}; // end namespace tautau_selection_gen
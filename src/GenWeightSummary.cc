@@ -0,0 +1,139 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/GenWeightSummary.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
+
+using namespace std;
+
+
+GenWeightSummary::GenWeightSummary() {
+    clear();
+}
+
+
+void GenWeightSummary::fill(const double& weight, const vector<double>& lheWeights, const vector<double>& psWeights) {
+    // the variations have to cover the same events as the nominal sum
+    checkWeightCount("LHE", lheSumWeights_, lheWeights);
+    checkWeightCount("parton shower", psSumWeights_, psWeights);
+
+    nEvents_++;
+    if (weight < 0.) {
+        nNegativeWeights_++;
+    }
+    util::compensatedAdd(sumWeights_, sumWeightsCompensation_, weight);
+    util::compensatedAdd(sumWeights2_, sumWeights2Compensation_, weight * weight);
+
+    // the weights of a single event carry no compensation
+    static const vector<double> noCompensation;
+    addWeights(lheSumWeights_, lheSumWeightsCompensation_, lheWeights, noCompensation);
+    addWeights(psSumWeights_, psSumWeightsCompensation_, psWeights, noCompensation);
+}
+
+
+void GenWeightSummary::add(const GenWeightSummary& other) {
+    if (other.nEvents_ == 0) {
+        return;
+    }
+    if (nEvents_ == 0) {
+        *this = other;
+        return;
+    }
+    checkWeightCount("LHE", lheSumWeights_, other.lheSumWeights_);
+    checkWeightCount("parton shower", psSumWeights_, other.psSumWeights_);
+
+    nEvents_ += other.nEvents_;
+    nNegativeWeights_ += other.nNegativeWeights_;
+    util::compensatedAdd(sumWeights_, sumWeightsCompensation_, other.sumWeights_);
+    util::compensatedAdd(sumWeights_, sumWeightsCompensation_, other.sumWeightsCompensation_);
+    util::compensatedAdd(sumWeights2_, sumWeights2Compensation_, other.sumWeights2_);
+    util::compensatedAdd(sumWeights2_, sumWeights2Compensation_, other.sumWeights2Compensation_);
+    addWeights(lheSumWeights_, lheSumWeightsCompensation_, other.lheSumWeights_, other.lheSumWeightsCompensation_);
+    addWeights(psSumWeights_, psSumWeightsCompensation_, other.psSumWeights_, other.psSumWeightsCompensation_);
+}
+
+
+bool GenWeightSummary::mergeProduct(const GenWeightSummary& other) {
+    add(other);
+    return true;
+}
+
+
+void GenWeightSummary::clear() {
+    nEvents_ = 0;
+    nNegativeWeights_ = 0;
+    sumWeights_ = 0.;
+    sumWeightsCompensation_ = 0.;
+    sumWeights2_ = 0.;
+    sumWeights2Compensation_ = 0.;
+    lheSumWeights_.clear();
+    lheSumWeightsCompensation_.clear();
+    psSumWeights_.clear();
+    psSumWeightsCompensation_.clear();
+}
+
+
+const uint64_t GenWeightSummary::nEvents() const {
+    return nEvents_;
+}
+
+
+const uint64_t GenWeightSummary::nNegativeWeights() const {
+    return nNegativeWeights_;
+}
+
+
+const double GenWeightSummary::sumWeights() const {
+    return sumWeights_ + sumWeightsCompensation_;
+}
+
+
+const double GenWeightSummary::sumWeights2() const {
+    return sumWeights2_ + sumWeights2Compensation_;
+}
+
+
+const vector<double> GenWeightSummary::lheSumWeights() const {
+    return getSums(lheSumWeights_, lheSumWeightsCompensation_);
+}
+
+
+const vector<double> GenWeightSummary::psSumWeights() const {
+    return getSums(psSumWeights_, psSumWeightsCompensation_);
+}
+
+
+void GenWeightSummary::checkWeightCount(const string& type, const vector<double>& sums, const vector<double>& weights) const {
+    // the first event sets the number of weights
+    if ((nEvents_ > 0) && (sums.size() != weights.size())) {
+        throw cms::Exception("InvalidGeneratorWeights") << "GenWeightSummary: " << weights.size() << " " << type
+            << " weights cannot be added to the sums of " << sums.size() << " weights";
+    }
+}
+
+
+void GenWeightSummary::addWeights(vector<double>& sums, vector<double>& compensations, const vector<double>& weights, const vector<double>& weightCompensations) {
+    if (sums.empty()) {
+        sums.resize(weights.size(), 0.);
+        compensations.resize(weights.size(), 0.);
+    }
+
+    for (size_t i = 0; i < weights.size(); ++i) {
+        util::compensatedAdd(sums[i], compensations[i], weights[i]);
+        if (!weightCompensations.empty()) {
+            util::compensatedAdd(sums[i], compensations[i], weightCompensations[i]);
+        }
+    }
+}
+
+
+const vector<double> GenWeightSummary::getSums(const vector<double>& sums, const vector<double>& compensations) {
+    vector<double> result(sums.size());
+    for (size_t i = 0; i < sums.size(); ++i) {
+        result[i] = sums[i] + compensations[i];
+    }
+    return result;
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TauAnalysis/TauTriggerNtuples/interface/HighLevelTriggerPath.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/HLTPathSelector.h"
+
+using namespace std;
+
+
+HLTPathSelector::HLTPathSelector() {
+    nodes_ = vector<TrieNode>();
+    globSuffixes_ = vector<string>();
+    addNode();
+}
+
+
+HLTPathSelector::HLTPathSelector(const vector<string>& selections) {
+    nodes_ = vector<TrieNode>();
+    globSuffixes_ = vector<string>();
+    addNode();
+
+    for (const string& selection : selections) {
+        // insert the literal prefix of the selection into the trie
+        size_t node = 0;
+        size_t pos = 0;
+        for (; pos < selection.size(); ++pos) {
+            const char c = selection[pos];
+            if (c == '*' || c == '?') {
+                break;
+            }
+            size_t child = findChild(node, c);
+            if (child == 0) {
+                child = addNode();
+                nodes_[node].children.push_back(pair<char, size_t>(c, child));
+            }
+            node = child;
+        }
+
+        // attach the remainder to the last node of the prefix
+        if (pos == selection.size()) {
+            nodes_[node].terminal = true;
+        } else {
+            nodes_[node].globs.push_back(globSuffixes_.size());
+            globSuffixes_.push_back(selection.substr(pos));
+        }
+    }
+}
+
+
+const bool HLTPathSelector::isSelected(const string& fullName) const {
+    const size_t versionPos = HighLevelTriggerPath::versionPosition(fullName);
+    if (versionPos == string::npos) {
+        return false;
+    }
+
+    const char* name = fullName.data();
+    const char* nameEnd = name + versionPos;
+
+    size_t node = 0;
+    for (const char* c = name; ; ++c) {
+        for (const size_t& glob : nodes_[node].globs) {
+            const string& suffix = globSuffixes_[glob];
+            if (matchGlob(c, nameEnd, suffix.data(), suffix.data() + suffix.size())) {
+                return true;
+            }
+        }
+        if (c == nameEnd) {
+            return nodes_[node].terminal;
+        }
+        node = findChild(node, *c);
+        if (node == 0) {
+            return false;
+        }
+    }
+}
+
+
+const size_t HLTPathSelector::addNode() {
+    nodes_.push_back(TrieNode{vector<pair<char, size_t>>(), vector<size_t>(), false});
+    return nodes_.size() - 1;
+}
+
+
+const size_t HLTPathSelector::findChild(const size_t& node, const char& c) const {
+    // the root can never be a child, so 0 flags a missing child
+    for (const pair<char, size_t>& child : nodes_[node].children) {
+        if (child.first == c) {
+            return child.second;
+        }
+    }
+    return 0;
+}
+
+
+const bool HLTPathSelector::matchGlob(const char* name, const char* nameEnd, const char* glob, const char* globEnd) {
+    // greedy matching, which only backtracks to the position of the last '*'
+    const char* starGlob = nullptr;
+    const char* starName = nullptr;
+    while (name != nameEnd) {
+        if (glob != globEnd && (*glob == '?' || *glob == *name)) {
+            ++glob;
+            ++name;
+        } else if (glob != globEnd && *glob == '*') {
+            starGlob = glob++;
+            starName = name;
+        } else if (starGlob != nullptr) {
+            glob = starGlob + 1;
+            name = ++starName;
+        } else {
+            return false;
+        }
+    }
+    while (glob != globEnd && *glob == '*') {
+        ++glob;
+    }
+    return glob == globEnd;
+}
@@ -1,4 +1,4 @@
-#include <regex>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -13,6 +13,7 @@ HighLevelTriggerPath::HighLevelTriggerPath() {
     index_ = -1;
     modules_ = vector<string>();
     modulesSaveTags_ = vector<string>();
+    moduleIndicesSaveTags_ = vector<int>();
 }
 
 HighLevelTriggerPath::HighLevelTriggerPath(const string& fullName, const int& index, const vector<string>& modules, const vector<string>& modulesSaveTags) {
@@ -20,40 +21,44 @@ HighLevelTriggerPath::HighLevelTriggerPath(const string& fullName, const int& in
     index_ = index;
     modules_ = modules;
     modulesSaveTags_ = modulesSaveTags;
+    moduleIndicesSaveTags_ = vector<int>();
+    for (const string& module : modulesSaveTags_) {
+        moduleIndicesSaveTags_.push_back(moduleIndex(module));
+    }
     const pair<string, string> nameSplit = splitName(fullName);
     name_ = nameSplit.first;
     version_ = nameSplit.second;
 }
 
-const string& HighLevelTriggerPath::fullName() {
+const string& HighLevelTriggerPath::fullName() const {
     return fullName_;
 }
 
-const string& HighLevelTriggerPath::name() {
+const string& HighLevelTriggerPath::name() const {
     return name_;
 }
 
-const string& HighLevelTriggerPath::version() {
+const string& HighLevelTriggerPath::version() const {
     return version_;
 }
 
-const int& HighLevelTriggerPath::index() {
+const int& HighLevelTriggerPath::index() const {
     return index_;
 }
 
-const vector<string>& HighLevelTriggerPath::modules() {
+const vector<string>& HighLevelTriggerPath::modules() const {
     return modules_;
 }
 
-const vector<string>& HighLevelTriggerPath::modulesSaveTags() {
+const vector<string>& HighLevelTriggerPath::modulesSaveTags() const {
     return modulesSaveTags_;
 }
 
-const bool HighLevelTriggerPath::isInModulesSaveTags(const string& module) {
+const bool HighLevelTriggerPath::isInModulesSaveTags(const string& module) const {
     return find(modulesSaveTags_.begin(), modulesSaveTags_.end(), module) != modulesSaveTags_.end();
 }
 
-const int HighLevelTriggerPath::moduleIndex(const string& module) {
+const int HighLevelTriggerPath::moduleIndex(const string& module) const {
     for (size_t i = 0; i < modules_.size(); ++i) {
         if (module == modules_.at(i)) {
             return i;
@@ -62,16 +67,40 @@ const int HighLevelTriggerPath::moduleIndex(const string& module) {
     return -1;
 }
 
-const pair<string, string> HighLevelTriggerPath::splitName(const string& fullName) {
-    string name = "";
-    string version = "";
-    smatch nameMatch;
-    if (regex_match(fullName, nameMatch, nameRegex_)) {
-        if (nameMatch.size() != 3) {
-            throw out_of_range("high level trigger path has not the expected format");
+const vector<int>& HighLevelTriggerPath::moduleIndicesSaveTags() const {
+    return moduleIndicesSaveTags_;
+}
+
+const uint64_t HighLevelTriggerPath::saveTagsMask(const int& lastModule, const bool& accept) const {
+    // bit i is set if the i-th saveTags filter of the path has been passed, i.e. it has been run before the last module
+    // or it is the last module of an accepted path; filters beyond the 64th are not encoded
+    uint64_t mask = 0;
+    const size_t nBits = min(moduleIndicesSaveTags_.size(), static_cast<size_t>(64));
+    for (size_t i = 0; i < nBits; ++i) {
+        const int moduleIndex = moduleIndicesSaveTags_[i];
+        if ((moduleIndex < lastModule) || (accept && moduleIndex == lastModule)) {
+            mask |= (uint64_t(1) << i);
         }
-        name = nameMatch[1].str();
-        version = nameMatch[2].str();
     }
-    return pair<string, string>({name, version});
-}
\ No newline at end of file
+    return mask;
+}
+
+const size_t HighLevelTriggerPath::versionPosition(const string& fullName) {
+    // position of the version suffix '_v<N>' at the end of the path name
+    size_t pos = fullName.size();
+    while (pos > 0 && fullName[pos - 1] >= '0' && fullName[pos - 1] <= '9') {
+        --pos;
+    }
+    if (pos == fullName.size() || pos < 3 || fullName[pos - 1] != 'v' || fullName[pos - 2] != '_') {
+        return string::npos;
+    }
+    return pos - 2;
+}
+
+const pair<string, string> HighLevelTriggerPath::splitName(const string& fullName) {
+    const size_t pos = versionPosition(fullName);
+    if (pos == string::npos) {
+        return pair<string, string>({"", ""});
+    }
+    return pair<string, string>({fullName.substr(0, pos), fullName.substr(pos + 1)});
+}
@@ -0,0 +1,83 @@
+#include <cstdint>
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPair.h"
+
+
+namespace tautau_selection_reco {
+
+
+TauTauPair::TauTauPair() {
+    finalState_ = TauTauFinalState::unknown;
+    first_ = edm::Ptr<reco::Candidate>();
+    second_ = edm::Ptr<reco::Candidate>();
+    firstIsoScore_ = 0.;
+    firstPtScore_ = 0.;
+    secondIsoScore_ = 0.;
+    secondPtScore_ = 0.;
+    firstIDBits_ = 0;
+    secondIDBits_ = 0;
+}
+
+
+TauTauPair::TauTauPair(
+    const TauTauFinalState& finalState,
+    const edm::Ptr<reco::Candidate>& first,
+    const edm::Ptr<reco::Candidate>& second,
+    const SortScore& firstSortScore,
+    const SortScore& secondSortScore,
+    const uint32_t& firstIDBits,
+    const uint32_t& secondIDBits
+) {
+    finalState_ = finalState;
+    first_ = first;
+    second_ = second;
+    firstIsoScore_ = firstSortScore.isoScore;
+    firstPtScore_ = firstSortScore.ptScore;
+    secondIsoScore_ = secondSortScore.isoScore;
+    secondPtScore_ = secondSortScore.ptScore;
+    firstIDBits_ = firstIDBits;
+    secondIDBits_ = secondIDBits;
+}
+
+
+const TauTauFinalState TauTauPair::finalState() const {
+    return static_cast<TauTauFinalState>(finalState_);
+}
+
+
+const bool TauTauPair::isValid() const {
+    return finalState_ != TauTauFinalState::unknown;
+}
+
+
+const edm::Ptr<reco::Candidate>& TauTauPair::first() const {
+    return first_;
+}
+
+
+const edm::Ptr<reco::Candidate>& TauTauPair::second() const {
+    return second_;
+}
+
+
+const SortScore TauTauPair::firstSortScore() const {
+    return SortScore{firstIsoScore_, firstPtScore_};
+}
+
+
+const SortScore TauTauPair::secondSortScore() const {
+    return SortScore{secondIsoScore_, secondPtScore_};
+}
+
+
+const uint32_t TauTauPair::firstIDBits() const {
+    return firstIDBits_;
+}
+
+
+const uint32_t TauTauPair::secondIDBits() const {
+    return secondIDBits_;
+}
+
+
+}; // end namespace tautau_selection_reco
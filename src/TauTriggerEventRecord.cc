@@ -0,0 +1,232 @@
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTriggerEventRecord.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
+
+using namespace std;
+
+
+GenTauDecayBranchSet::GenTauDecayBranchSet(const string& prefix) : prefix(prefix) {
+    clear();
+}
+
+
+void GenTauDecayBranchSet::branch(TreeBranchBinder& binder) {
+    binder.addScalar(prefix + "FinalState", &finalState, prefix + "FinalState/I");
+    binder.addScalar(prefix + "DecayMode", &decayMode, prefix + "DecayMode/I");
+    binder.addScalar(prefix + "VisPt", &visPt, prefix + "VisPt/F");
+    binder.addScalar(prefix + "VisEta", &visEta, prefix + "VisEta/F");
+    binder.addScalar(prefix + "VisPhi", &visPhi, prefix + "VisPhi/F");
+    binder.addScalar(prefix + "VisMass", &visMass, prefix + "VisMass/F");
+    binder.addScalar(prefix + "NuPt", &nuPt, prefix + "NuPt/F");
+    binder.addScalar(prefix + "NuEta", &nuEta, prefix + "NuEta/F");
+    binder.addScalar(prefix + "NuPhi", &nuPhi, prefix + "NuPhi/F");
+    binder.addScalar(prefix + "NuMass", &nuMass, prefix + "NuMass/F");
+}
+
+
+void GenTauDecayBranchSet::clear() {
+    finalState = -1;
+    decayMode = -1;
+    visPt = 0.;
+    visEta = 0.;
+    visPhi = 0.;
+    visMass = 0.;
+    nuPt = 0.;
+    nuEta = 0.;
+    nuPhi = 0.;
+    nuMass = 0.;
+}
+
+
+void GenTauDecayBranchSet::fill(const tautau_selection_gen::GenTauDecay& decay) {
+    finalState = decay.finalState;
+    decayMode = decay.decayMode;
+    visPt = decay.visibleP4.pt();
+    visEta = decay.visibleP4.eta();
+    visPhi = decay.visibleP4.phi();
+    visMass = decay.visibleP4.mass();
+    nuPt = decay.neutrinoP4.pt();
+    nuEta = decay.neutrinoP4.eta();
+    nuPhi = decay.neutrinoP4.phi();
+    nuMass = decay.neutrinoP4.mass();
+}
+
+
+void GenTauDecayBranchSet::reducePrecision() {
+    visEta = util::reduceMantissa<12>(visEta);
+    visPhi = util::reduceMantissa<12>(visPhi);
+    visMass = util::reduceMantissa<10>(visMass);
+    nuEta = util::reduceMantissa<12>(nuEta);
+    nuPhi = util::reduceMantissa<12>(nuPhi);
+    nuMass = util::reduceMantissa<10>(nuMass);
+}
+
+
+TauTriggerEventRecord::TauTriggerEventRecord() :
+    genTau1("genTau1"),
+    genTau2("genTau2"),
+    genParticles("genParticle"),
+    pairElectrons("pairElectron"),
+    pairMuons("pairMuon"),
+    pairTaus("pairTau"),
+    triggerObjects("triggerObject")
+{
+    clear();
+}
+
+
+void TauTriggerEventRecord::branch(TreeBranchBinder& binder) {
+    binder.addScalar("lumi", &lumi, "lumi/L");
+    binder.addScalar("run", &run,  "run/L");
+    binder.addScalar("event", &event, "event/L");
+    binder.addScalar("isElTau", &isElTau, "isElTau/O");
+    binder.addScalar("isMuTau", &isMuTau, "isMuTau/O");
+    binder.addScalar("isTauTau", &isTauTau, "isTauTau/O");
+    binder.addScalar("genWeight", &genWeight, "genWeight/F");
+    binder.addScalar("genFinalState", &genFinalState, "genFinalState/I");
+    genTau1.branch(binder);
+    genTau2.branch(binder);
+    binder.addScalar("hltMenuId", &hltMenuId, "hltMenuId/I");
+    genParticles.branch(binder);
+    pairElectrons.branch(binder);
+    pairMuons.branch(binder);
+    pairTaus.branch(binder);
+    triggerObjects.branch(binder);
+    binder.addColumn("pairElectron", "pairElectronTriggerObjectIndex", &pairElectronTriggerObjectIndex);
+    binder.addColumn("pairMuon", "pairMuonTriggerObjectIndex", &pairMuonTriggerObjectIndex);
+    binder.addColumn("pairTau", "pairTauTriggerObjectIndex", &pairTauTriggerObjectIndex);
+    binder.addColumn("triggerAssoc", "triggerAssocObjectIndex", &triggerAssocObjectIndex);
+    binder.addColumn("triggerAssoc", "triggerAssocHLTPathIndex", &triggerAssocHLTPathIndex);
+    binder.addColumn("triggerAssoc", "triggerAssocModuleIndex", &triggerAssocModuleIndex);
+    binder.addColumn("triggerAssoc", "triggerAssocType", &triggerAssocType);
+    binder.addColumn("triggerObjectPath", "triggerObjectPathObjectIndex", &triggerObjectPathObjectIndex);
+    binder.addColumn("triggerObjectPath", "triggerObjectPathHLTPathIndex", &triggerObjectPathHLTPathIndex);
+    binder.addColumn("triggerObjectPath", "triggerObjectPathMask", &triggerObjectPathMask);
+    binder.addColumn("hltPath", "hltPathLastModule", &hltPathLastModule);
+    binder.addColumn("hltPath", "hltPathLastModuleState", &hltPathLastModuleState);
+    binder.addColumn("hltPath", "hltPathSaveTagsMask", &hltPathSaveTagsMask);
+    binder.addColumn("pairLegPath", "pairLegPathLegType", &pairLegPathLegType);
+    binder.addColumn("pairLegPath", "pairLegPathLegIndex", &pairLegPathLegIndex);
+    binder.addColumn("pairLegPath", "pairLegPathHLTPathIndex", &pairLegPathHLTPathIndex);
+    binder.addColumn("pairLegPath", "pairLegPathDeepestModule", &pairLegPathDeepestModule);
+    binder.addColumn("pairLegPath", "pairLegPathMask", &pairLegPathMask);
+}
+
+
+void TauTriggerEventRecord::clear() {
+    lumi = -1;
+    run = -1;
+    event = -1;
+    isElTau = false;
+    isMuTau = false;
+    isTauTau = false;
+    genWeight = 1.;
+    genFinalState = -1;
+    genTau1.clear();
+    genTau2.clear();
+    hltMenuId = -1;
+    genParticles.clear();
+    pairElectrons.clear();
+    pairMuons.clear();
+    pairTaus.clear();
+    triggerObjects.clear();
+    pairElectronTriggerObjectIndex.clear();
+    pairMuonTriggerObjectIndex.clear();
+    pairTauTriggerObjectIndex.clear();
+    triggerAssocObjectIndex.clear();
+    triggerAssocHLTPathIndex.clear();
+    triggerAssocModuleIndex.clear();
+    triggerAssocType.clear();
+    triggerObjectPathObjectIndex.clear();
+    triggerObjectPathHLTPathIndex.clear();
+    triggerObjectPathMask.clear();
+    hltPathLastModule.clear();
+    hltPathLastModuleState.clear();
+    hltPathSaveTagsMask.clear();
+    pairLegPathLegType.clear();
+    pairLegPathLegIndex.clear();
+    pairLegPathHLTPathIndex.clear();
+    pairLegPathDeepestModule.clear();
+    pairLegPathMask.clear();
+}
+
+
+// rounds the reducible columns of the candidate collections and the generator-level decays, the record is stored with
+// full precision otherwise
+void TauTriggerEventRecord::reducePrecision() {
+    genTau1.reducePrecision();
+    genTau2.reducePrecision();
+    genParticles.reducePrecision();
+    pairElectrons.reducePrecision();
+    pairMuons.reducePrecision();
+    pairTaus.reducePrecision();
+    triggerObjects.reducePrecision();
+}
+
+
+const tuple<long int, long int, long int> TauTriggerEventRecord::sortKey() const {
+    return make_tuple(run, lumi, event);
+}
+
+
+TauTriggerHLTRecord::TauTriggerHLTRecord() {
+    clear();
+}
+
+
+void TauTriggerHLTRecord::branch(TreeBranchBinder& binder) {
+    binder.addScalar("hltMenuId", &hltMenuId, "hltMenuId/I");
+    binder.addObject("hltTableName", &hltTableName);
+    binder.addObject("hltGlobalTag", &hltGlobalTag);
+    binder.addObject("hltProcessPSetHash", &hltProcessPSetHash);
+    binder.addScalar("hltPathSlot", &hltPathSlot, "hltPathSlot/I");
+    binder.addObject("hltPathName", &hltPathName);
+    binder.addObject("hltPathVersion", &hltPathVersion);
+    binder.addScalar("hltPathIndex", &hltPathIndex, "hltPathIndex/I");
+    binder.addObject("hltPathModuleLabelIds", &hltPathModuleLabelIds);
+    binder.addObject("hltPathSaveTagsLabelIds", &hltPathSaveTagsLabelIds);
+}
+
+
+void TauTriggerHLTRecord::clear() {
+    hltMenuId = -1;
+    hltTableName = "";
+    hltGlobalTag = "";
+    hltProcessPSetHash = "";
+    hltPathSlot = -1;
+    hltPathName = "";
+    hltPathVersion = "";
+    hltPathIndex = -1;
+    hltPathModuleLabelIds.clear();
+    hltPathSaveTagsLabelIds.clear();
+}
+
+
+const tuple<long int, long int, long int> TauTriggerHLTRecord::sortKey() const {
+    return make_tuple(static_cast<long int>(hltMenuId), static_cast<long int>(hltPathSlot), 0L);
+}
+
+
+TauTriggerModuleLabelRecord::TauTriggerModuleLabelRecord() {
+    clear();
+}
+
+
+void TauTriggerModuleLabelRecord::branch(TreeBranchBinder& binder) {
+    binder.addScalar("hltModuleLabelId", &hltModuleLabelId, "hltModuleLabelId/I");
+    binder.addObject("hltModuleLabel", &hltModuleLabel);
+}
+
+
+void TauTriggerModuleLabelRecord::clear() {
+    hltModuleLabelId = -1;
+    hltModuleLabel = "";
+}
+
+
+const tuple<long int, long int, long int> TauTriggerModuleLabelRecord::sortKey() const {
+    return make_tuple(static_cast<long int>(hltModuleLabelId), 0L, 0L);
+}
@@ -0,0 +1,76 @@
+#include <cctype>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeBranchBinder.h"
+
+using namespace std;
+
+
+const TreeLayout getTreeLayout(const string& name) {
+    if (name == "vector") {
+        return TreeLayout::vectorBranches;
+    }
+    if (name == "flat") {
+        return TreeLayout::flatArrays;
+    }
+    throw cms::Exception("Configuration") << "getTreeLayout: unknown tree layout '" << name << "', must be 'vector' or 'flat'";
+}
+
+
+TreeBranchBinder::TreeBranchBinder() {
+    tree_ = nullptr;
+    layout_ = TreeLayout::vectorBranches;
+    groups_ = vector<FlatGroup>();
+    columns_ = vector<FlatColumn>();
+}
+
+
+TreeBranchBinder::TreeBranchBinder(TTree* tree, const TreeLayout& layout) {
+    tree_ = tree;
+    layout_ = layout;
+    groups_ = vector<FlatGroup>();
+    columns_ = vector<FlatColumn>();
+}
+
+
+void TreeBranchBinder::prepare() {
+    if (layout_ != TreeLayout::flatArrays) {
+        return;
+    }
+
+    // the first column of a collection defines its length
+    for (FlatGroup& group : groups_) {
+        *group.counter = static_cast<Int_t>(columns_[group.firstColumn].size());
+    }
+    for (FlatColumn& column : columns_) {
+        if (static_cast<Int_t>(column.size()) != *groups_[column.group].counter) {
+            throw logic_error("TreeBranchBinder: columns of collection '" + groups_[column.group].name + "' differ in length");
+        }
+        column.branch->SetAddress(column.data());
+    }
+}
+
+
+const size_t TreeBranchBinder::getGroup(const string& group) {
+    // the counter of the collection 'pairTau' is called 'nPairTau'
+    string counterName = "n" + group;
+    if (counterName.size() > 1) {
+        counterName[1] = toupper(counterName[1]);
+    }
+
+    for (size_t i = 0; i < groups_.size(); ++i) {
+        if (groups_[i].name == counterName) {
+            return i;
+        }
+    }
+
+    // the column that is added right after the creation of the group is its first column
+    groups_.push_back(FlatGroup{counterName, make_unique<Int_t>(0), columns_.size()});
+    tree_->Branch(counterName.c_str(), groups_.back().counter.get(), (counterName + "/I").c_str());
+    return groups_.size() - 1;
+}
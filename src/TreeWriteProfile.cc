@@ -0,0 +1,159 @@
+#include <fnmatch.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Compression.h>
+#include <RVersion.h>
+#include <TBranch.h>
+#include <TIterator.h>
+#include <TObjArray.h>
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TreeWriteProfile.h"
+
+using namespace std;
+
+
+TreeWriteProfile::TreeWriteProfile() {
+    name_ = "default";
+    compressionSettings_ = -1;
+    basketSize_ = -1;
+    autoFlush_ = 0;
+    branchSettings_ = vector<BranchWriteSettings>();
+}
+
+
+TreeWriteProfile::TreeWriteProfile(const edm::ParameterSet& pset) {
+    name_ = pset.getUntrackedParameter<string>("profile", "default");
+
+    // defaults of the selected profile
+    string algorithm = "";
+    int level = -1;
+    basketSize_ = -1;
+    autoFlush_ = 0;
+    if (name_ == "fastWrite") {
+        algorithm = "LZ4";
+        level = 4;
+        basketSize_ = 1024000;
+        autoFlush_ = -100000000;
+    } else if (name_ == "archive") {
+        algorithm = "LZMA";
+        level = 9;
+        basketSize_ = 256000;
+        autoFlush_ = -30000000;
+    } else if (name_ != "default") {
+        throw cms::Exception("Configuration") << "TreeWriteProfile: unknown write profile '" << name_ << "'";
+    }
+
+    // explicit settings on top of the profile
+    const string configAlgorithm = pset.getUntrackedParameter<string>("compressionAlgorithm", "");
+    const int configLevel = pset.getUntrackedParameter<int>("compressionLevel", -1);
+    const int configBasketSize = pset.getUntrackedParameter<int>("basketSize", -1);
+    const long long configAutoFlush = pset.getUntrackedParameter<long long>("autoFlush", 0);
+    if (!configAlgorithm.empty()) {
+        algorithm = configAlgorithm;
+        level = configLevel;
+    } else if (configLevel >= 0) {
+        level = configLevel;
+    }
+    if (configBasketSize > 0) {
+        basketSize_ = configBasketSize;
+    }
+    if (configAutoFlush != 0) {
+        autoFlush_ = configAutoFlush;
+    }
+    compressionSettings_ = (algorithm.empty() && level < 0) ? -1 : getCompressionSettings(algorithm, level);
+
+    // per-branch settings, the last matching entry wins
+    branchSettings_ = vector<BranchWriteSettings>();
+    for (const edm::ParameterSet& branchPSet : pset.getUntrackedParameter<vector<edm::ParameterSet>>("branchSettings", vector<edm::ParameterSet>())) {
+        const string branchAlgorithm = branchPSet.getUntrackedParameter<string>("compressionAlgorithm", "");
+        const int branchLevel = branchPSet.getUntrackedParameter<int>("compressionLevel", -1);
+        BranchWriteSettings settings = BranchWriteSettings{
+            branchPSet.getUntrackedParameter<string>("branches"),
+            (branchAlgorithm.empty() && branchLevel < 0) ? -1 : getCompressionSettings(branchAlgorithm.empty() ? algorithm : branchAlgorithm, branchLevel),
+            branchPSet.getUntrackedParameter<int>("basketSize", -1)
+        };
+        if (settings.pattern.empty()) {
+            throw cms::Exception("Configuration") << "TreeWriteProfile: branch settings without a branch pattern";
+        }
+        if ((settings.compressionSettings < 0) && (settings.basketSize <= 0)) {
+            throw cms::Exception("Configuration") << "TreeWriteProfile: branch settings for '" << settings.pattern << "' set neither a compression nor a basket size";
+        }
+        branchSettings_.push_back(settings);
+    }
+}
+
+
+void TreeWriteProfile::apply(TTree* tree) const {
+    if (autoFlush_ != 0) {
+        tree->SetAutoFlush(autoFlush_);
+    }
+
+    TIter nextBranch(tree->GetListOfBranches());
+    while (TBranch* branch = static_cast<TBranch*>(nextBranch())) {
+        int compressionSettings = compressionSettings_;
+        int basketSize = basketSize_;
+        for (const BranchWriteSettings& settings : branchSettings_) {
+            if (fnmatch(settings.pattern.c_str(), branch->GetName(), 0) != 0) {
+                continue;
+            }
+            if (settings.compressionSettings >= 0) {
+                compressionSettings = settings.compressionSettings;
+            }
+            if (settings.basketSize > 0) {
+                basketSize = settings.basketSize;
+            }
+        }
+
+        // both setters also apply to the sub-branches
+        if (compressionSettings >= 0) {
+            branch->SetCompressionSettings(compressionSettings);
+        }
+        if (basketSize > 0) {
+            branch->SetBasketSize(basketSize);
+        }
+    }
+}
+
+
+const string TreeWriteProfile::report(TTree* tree) const {
+    // write the remaining baskets, so that the sizes cover all entries of the tree
+    tree->FlushBaskets();
+
+    const double totBytes = static_cast<double>(tree->GetTotBytes());
+    const double zipBytes = static_cast<double>(tree->GetZipBytes());
+
+    ostringstream summary;
+    summary << "tree '" << tree->GetName() << "' written with profile '" << name_ << "': "
+            << tree->GetEntries() << " entries, "
+            << totBytes / 1.0e6 << " MB uncompressed, "
+            << zipBytes / 1.0e6 << " MB compressed, "
+            << "compression ratio " << (zipBytes > 0. ? totBytes / zipBytes : 0.);
+    return summary.str();
+}
+
+
+const int TreeWriteProfile::getCompressionSettings(const string& algorithm, const int& level) {
+    if (algorithm == "ZLIB") {
+        return ROOT::CompressionSettings(ROOT::kZLIB, level < 0 ? 6 : level);
+    }
+    if (algorithm == "LZMA") {
+        return ROOT::CompressionSettings(ROOT::kLZMA, level < 0 ? 9 : level);
+    }
+    if (algorithm == "LZ4") {
+        return ROOT::CompressionSettings(ROOT::kLZ4, level < 0 ? 4 : level);
+    }
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 20, 0)
+    if (algorithm == "ZSTD") {
+        return ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZSTD, level < 0 ? 5 : level);
+    }
+#endif
+    if (algorithm.empty()) {
+        throw cms::Exception("Configuration") << "TreeWriteProfile: a compression level requires a compression algorithm";
+    }
+    throw cms::Exception("Configuration") << "TreeWriteProfile: compression algorithm '" << algorithm << "' is not supported by this ROOT version";
+}
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TriggerFilterIndex.h"
+
+using namespace std;
+
+
+TriggerFilterIndex::TriggerFilterIndex() {
+    ranges_ = unordered_map<string, pair<size_t, size_t>>();
+    entries_ = vector<TriggerFilterEntry>();
+}
+
+
+TriggerFilterIndex::TriggerFilterIndex(const vector<shared_ptr<HighLevelTriggerPath>>& hltPaths) {
+    // collect the saveTags filters of all paths
+    vector<pair<string, TriggerFilterEntry>> labeledEntries = vector<pair<string, TriggerFilterEntry>>();
+    for (size_t pathSlot = 0; pathSlot < hltPaths.size(); ++pathSlot) {
+        const shared_ptr<HighLevelTriggerPath>& hltPath = hltPaths.at(pathSlot);
+        const vector<string>& modulesSaveTags = hltPath->modulesSaveTags();
+        for (size_t saveTagsIndex = 0; saveTagsIndex < modulesSaveTags.size(); ++saveTagsIndex) {
+            labeledEntries.push_back(pair<string, TriggerFilterEntry>({
+                modulesSaveTags.at(saveTagsIndex),
+                TriggerFilterEntry{pathSlot, hltPath->index(), hltPath->moduleIndicesSaveTags().at(saveTagsIndex), saveTagsIndex}
+            }));
+        }
+    }
+
+    // group the entries by filter label, the order of the paths is kept within each group
+    stable_sort(
+        labeledEntries.begin(),
+        labeledEntries.end(),
+        [] (const pair<string, TriggerFilterEntry>& e1, const pair<string, TriggerFilterEntry>& e2) { return e1.first < e2.first; }
+    );
+
+    entries_ = vector<TriggerFilterEntry>();
+    entries_.reserve(labeledEntries.size());
+    ranges_ = unordered_map<string, pair<size_t, size_t>>();
+    ranges_.reserve(labeledEntries.size());
+    for (size_t i = 0; i < labeledEntries.size(); ++i) {
+        if (i == 0 || labeledEntries.at(i).first != labeledEntries.at(i - 1).first) {
+            ranges_[labeledEntries.at(i).first] = pair<size_t, size_t>(i, i);
+        }
+        ranges_[labeledEntries.at(i).first].second = i + 1;
+        entries_.push_back(labeledEntries.at(i).second);
+    }
+}
+
+
+const pair<const TriggerFilterEntry*, const TriggerFilterEntry*> TriggerFilterIndex::find(const string& filterLabel) const {
+    const auto range = ranges_.find(filterLabel);
+    if (range == ranges_.end()) {
+        return pair<const TriggerFilterEntry*, const TriggerFilterEntry*>(nullptr, nullptr);
+    }
+    return pair<const TriggerFilterEntry*, const TriggerFilterEntry*>(
+        entries_.data() + range->second.first,
+        entries_.data() + range->second.second
+    );
+}
+
+
+const size_t TriggerFilterIndex::size() const {
+    return entries_.size();
+}
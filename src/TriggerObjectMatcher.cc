@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/TriggerObjectMatcher.h"
+
+using namespace std;
+
+
+TriggerObjectMatcher::TriggerObjectMatcher() : TriggerObjectMatcher(0.5) {}
+
+
+TriggerObjectMatcher::TriggerObjectMatcher(const double& maxDeltaR) {
+    if (maxDeltaR <= 0.) {
+        throw cms::Exception("Configuration") << "TriggerObjectMatcher: the matching cone must be positive, check triggerMatchDeltaR";
+    }
+    maxDeltaR2_ = maxDeltaR * maxDeltaR;
+
+    // the cells are at least as large as the cone in both directions, the phi cells cover the full circle
+    etaMax_ = 5.;
+    nEtaCells_ = max(static_cast<size_t>(2. * etaMax_ / maxDeltaR), size_t(1));
+    etaCellSize_ = 2. * etaMax_ / nEtaCells_;
+    nPhiCells_ = max(static_cast<size_t>(2. * M_PI / maxDeltaR), size_t(1));
+    phiCellSize_ = 2. * M_PI / nPhiCells_;
+
+    etas_ = vector<double>();
+    phis_ = vector<double>();
+    cells_ = vector<size_t>();
+    cellOffsets_ = vector<size_t>(nEtaCells_ * nPhiCells_ + 1, 0);
+    cellObjects_ = vector<size_t>();
+}
+
+
+void TriggerObjectMatcher::clear() {
+    etas_.clear();
+    phis_.clear();
+    cells_.clear();
+    cellObjects_.clear();
+}
+
+
+const size_t TriggerObjectMatcher::add(const double& eta, const double& phi) {
+    etas_.push_back(eta);
+    phis_.push_back(phi);
+    cells_.push_back(etaCell(eta) * nPhiCells_ + phiCell(phi));
+    return etas_.size() - 1;
+}
+
+
+void TriggerObjectMatcher::build() {
+    // counting sort of the objects by cell, the objects of cell i are cellObjects_[cellOffsets_[i], cellOffsets_[i + 1])
+    fill(cellOffsets_.begin(), cellOffsets_.end(), 0);
+    for (const size_t& cell : cells_) {
+        cellOffsets_[cell + 1]++;
+    }
+    for (size_t i = 1; i < cellOffsets_.size(); ++i) {
+        cellOffsets_[i] += cellOffsets_[i - 1];
+    }
+
+    // placing an object advances the offset of its cell, afterwards each offset points to the start of the next cell
+    cellObjects_.resize(cells_.size());
+    for (size_t i = 0; i < cells_.size(); ++i) {
+        cellObjects_[cellOffsets_[cells_[i]]++] = i;
+    }
+    for (size_t i = cellOffsets_.size() - 1; i > 0; --i) {
+        cellOffsets_[i] = cellOffsets_[i - 1];
+    }
+    cellOffsets_[0] = 0;
+}
+
+
+void TriggerObjectMatcher::match(const double& eta, const double& phi, vector<size_t>& matches) const {
+    matches.clear();
+    if (etas_.empty()) {
+        return;
+    }
+
+    const size_t centerEtaCell = etaCell(eta);
+    const size_t centerPhiCell = phiCell(phi);
+    const size_t firstEtaCell = centerEtaCell > 0 ? centerEtaCell - 1 : 0;
+    const size_t lastEtaCell = min(centerEtaCell + 1, nEtaCells_ - 1);
+
+    // with less than three phi cells the neighbours wrap onto the same cells, each cell is visited once
+    const size_t nPhiNeighbours = min(nPhiCells_, size_t(3));
+    for (size_t i = firstEtaCell; i <= lastEtaCell; ++i) {
+        for (size_t j = 0; j < nPhiNeighbours; ++j) {
+            const size_t cell = i * nPhiCells_ + (centerPhiCell + nPhiCells_ - 1 + j) % nPhiCells_;
+            for (size_t k = cellOffsets_[cell]; k < cellOffsets_[cell + 1]; ++k) {
+                if (deltaR2(cellObjects_[k], eta, phi) < maxDeltaR2_) {
+                    matches.push_back(cellObjects_[k]);
+                }
+            }
+        }
+    }
+
+    // report the matches in the order in which the objects have been added
+    sort(matches.begin(), matches.end());
+}
+
+
+const double TriggerObjectMatcher::deltaR2(const size_t& object, const double& eta, const double& phi) const {
+    const double deltaEta = etas_[object] - eta;
+    double deltaPhi = phis_[object] - phi;
+    if (deltaPhi > M_PI) {
+        deltaPhi -= 2. * M_PI;
+    } else if (deltaPhi <= -M_PI) {
+        deltaPhi += 2. * M_PI;
+    }
+    return deltaEta * deltaEta + deltaPhi * deltaPhi;
+}
+
+
+const size_t TriggerObjectMatcher::size() const {
+    return etas_.size();
+}
+
+
+const size_t TriggerObjectMatcher::etaCell(const double& eta) const {
+    // clamping keeps neighbouring objects in neighbouring cells
+    const double clamped = min(max(eta, -etaMax_), etaMax_);
+    return min(static_cast<size_t>((clamped + etaMax_) / etaCellSize_), nEtaCells_ - 1);
+}
+
+
+const size_t TriggerObjectMatcher::phiCell(const double& phi) const {
+    // the phi of a candidate is in [-pi, pi]
+    const double shifted = phi + M_PI;
+    const size_t cell = shifted > 0. ? static_cast<size_t>(shifted / phiCellSize_) : 0;
+    return min(cell, nPhiCells_ - 1);
+}
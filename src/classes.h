@@ -0,0 +1,7 @@
+#include "DataFormats/Common/interface/Wrapper.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenTauTauFinalState.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/GenWeightSummary.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPair.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TauTauPreselection.h"
@@ -2,12 +2,16 @@
 #define GUARD_TAUTAUPAIRALGORITHM_H
 
 // system include files
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 // user include files
 #include "DataFormats/Candidate/interface/Candidate.h"
 #include "DataFormats/HepMCCandidate/interface/GenParticle.h"
 
+#include "TauAnalysis/TauTriggerNtuples/interface/GenDecayTree.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
 
 using namespace reco;
@@ -17,10 +21,169 @@ using namespace std;
 namespace tautau_selection_gen {
 
 
+// counts of the leptons and neutrinos among the decay products of a tau
+struct TauDecayCounts {
+    int nEle;
+    int nNuEle;
+    int nMu;
+    int nNuMu;
+    int nNuTau;
+
+    void add(const int& pdgId) {
+        const int absPdgId = abs(pdgId);
+        if (absPdgId == 11) {
+            nEle++;
+        } else if (absPdgId == 12) {
+            nNuEle++;
+        } else if (absPdgId == 13) {
+            nMu++;
+        } else if (absPdgId == 14) {
+            nNuMu++;
+        } else if (absPdgId == 16) {
+            nNuTau++;
+        }
+    }
+};
+
+
+static const TauFinalState classifyTauDecay(const TauDecayCounts& counts) {
+    // get tau decay mode
+    if ((counts.nEle == 1) && (counts.nNuEle == 1) && (counts.nMu == 0) && (counts.nNuMu == 0) && (counts.nNuTau == 1)) {
+        return TauFinalState::tauToE;
+    }
+    if ((counts.nEle == 0) && (counts.nNuEle == 0) && (counts.nMu == 1) && (counts.nNuMu == 1) && (counts.nNuTau == 1)) {
+        return TauFinalState::tauToM;
+    } 
+    if ((counts.nEle == 0) && (counts.nNuEle == 0) && (counts.nMu == 0) && (counts.nNuMu == 0) && (counts.nNuTau == 1)) {
+        return TauFinalState::tauToT;
+    } 
+
+    // if none of the above is true, the decay mode is unknown
+    return TauFinalState::tauToUnknown;
+}
+
+
+// decay mode of a hadronic tau decay from its direct daughters, -1 if there is a charged lepton or no charged hadron
+static const int classifyTauDecayMode(const int& nChargedLeptons, const int& nChargedHadrons, const int& nPi0) {
+    if ((nChargedLeptons > 0) || (nChargedHadrons == 0)) {
+        return -1;
+    }
+    return 5 * (nChargedHadrons - 1) + nPi0;
+}
+
+
+// adds a direct daughter of a tau to the counts of classifyTauDecayMode
+static void countTauDecayProduct(const int& pdgId, const int& charge, int& nChargedLeptons, int& nChargedHadrons, int& nPi0) {
+    const int absPdgId = abs(pdgId);
+    if ((absPdgId == 11) || (absPdgId == 13)) {
+        nChargedLeptons++;
+    } else if (absPdgId == 111) {
+        nPi0++;
+    } else if (charge != 0) {
+        nChargedHadrons++;
+    }
+}
+
+
+// adds a direct daughter of a tau to the neutrino or to the visible four-momentum of its decay
+static void addTauDecayProduct(const int& pdgId, const math::XYZTLorentzVector& p4, GenTauDecay& decay) {
+    const int absPdgId = abs(pdgId);
+    if ((absPdgId == 12) || (absPdgId == 14) || (absPdgId == 16)) {
+        decay.neutrinoP4 += p4;
+    } else {
+        decay.visibleP4 += p4;
+    }
+}
+
+
+// final state of a pair of prompt leptons from their absolute PDG IDs, unknown if the pair is neither ee nor mu mu
+static const HZGammaFinalState classifyPromptPair(const int& absPdgId1, const int& absPdgId2) {
+    if ((absPdgId1 == 11) && (absPdgId2 == 11)) {
+        return HZGammaFinalState::eePrompt;
+    }
+    if ((absPdgId1 == 13) && (absPdgId2 == 13)) {
+        return HZGammaFinalState::mmPrompt;
+    }
+    return HZGammaFinalState::unknown;
+}
+
+
+// final state of a tau pair from the final states of the two taus, in either order
+static const HZGammaFinalState classifyTauPair(const TauFinalState (&tauFinalStates)[2]) {
+    const pair<size_t, size_t> indexPairs[2] = {pair<size_t, size_t>(0, 1), pair<size_t, size_t>(1, 0)};
+    for (size_t i = 0; i < 2; ++i) {
+
+        size_t i1 = indexPairs[i].first;
+        size_t i2 = indexPairs[i].second;
+
+        if ((tauFinalStates[i1] == TauFinalState::tauToUnknown) || (tauFinalStates[i2] == TauFinalState::tauToUnknown)) {
+            return HZGammaFinalState::unknown;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToE) && (tauFinalStates[i2] == TauFinalState::tauToT)) {
+            return HZGammaFinalState::et;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToM) && (tauFinalStates[i2] == TauFinalState::tauToT)) {
+            return HZGammaFinalState::mt;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToT) && (tauFinalStates[i2] == TauFinalState::tauToT)) {
+            return HZGammaFinalState::tt;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToE) && (tauFinalStates[i2] == TauFinalState::tauToE)) {
+            return HZGammaFinalState::ee;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToM) && (tauFinalStates[i2] == TauFinalState::tauToM)) {
+            return HZGammaFinalState::mm;
+        }
+        if ((tauFinalStates[i1] == TauFinalState::tauToE) && (tauFinalStates[i2] == TauFinalState::tauToM)) {
+            return HZGammaFinalState::em;
+        }
+
+    }
+
+    // if all decisions have been false up to here, the decay mode is not known
+    return HZGammaFinalState::unknown;
+}
+
+
+// pair of the first flavour with two opposite-sign leptons, see findPairLeptons
+template <typename T, typename ChargeProduct>
+static const DileptonSearchStatus selectPairLeptons(
+    const size_t (&nLeptons)[3],
+    const T (&leptons)[3][2],
+    const ChargeProduct& chargeProduct,
+    T& lepton1,
+    T& lepton2
+) {
+    for (size_t flavour = 0; flavour < 3; ++flavour) {
+        if ((nLeptons[flavour] == 2) && (chargeProduct(leptons[flavour][0], leptons[flavour][1]) == -1)) {
+            lepton1 = leptons[flavour][0];
+            lepton2 = leptons[flavour][1];
+            return DileptonSearchStatus::pairFound;
+        }
+    }
+
+    for (size_t flavour = 0; flavour < 3; ++flavour) {
+        if (nLeptons[flavour] > 2) {
+            return DileptonSearchStatus::tooManyLeptons;
+        }
+        if (nLeptons[flavour] == 2) {
+            return DileptonSearchStatus::sameSignLeptons;
+        }
+    }
+
+    return DileptonSearchStatus::missingLeptons;
+}
+
+
+static const bool isHZGammaPdgId(const int& pdgId) {
+    const int absPdgId = abs(pdgId);
+    return (absPdgId == 22) || (absPdgId == 23) || (absPdgId == 25);
+}
+
+
 const GenParticle& getHZGammaBoson(const vector<GenParticle>& genParticles) {
     for (const GenParticle& genParticle : genParticles) {
-        int pdgId = abs(genParticle.pdgId());
-        if ((pdgId != 22) && (pdgId != 23) && (pdgId != 25)) {
+        if (!isHZGammaPdgId(genParticle.pdgId())) {
             continue;
         }
         if (genParticle.numberOfDaughters() > 0 && genParticle.isLastCopy()) {
@@ -29,40 +192,87 @@ const GenParticle& getHZGammaBoson(const vector<GenParticle>& genParticles) {
     }
 
     throw runtime_error("getHZGammaBoson: no valid boson found");
+}
 
-    const GenParticle* dummy = new GenParticle();
 
-    return *dummy;
+const uint32_t getHZGammaBoson(const GenDecayTree& tree) {
+    const vector<int>& pdgIds = tree.pdgIds();
+    for (uint32_t i = 0; i < tree.size(); ++i) {
+        if (!isHZGammaPdgId(pdgIds[i])) {
+            continue;
+        }
+        if (tree.daughters(i).size() > 0 && tree.hasStatusFlag(i, GenStatusFlags::kIsLastCopy)) {
+            return i;
+        }
+    }
+
+    throw runtime_error("getHZGammaBoson: no valid boson found");
 }
 
 
-const bool setPairLeptons(const vector<GenParticle>& genParticles, const int& pdgIdLepton, GenParticle& lepton1, GenParticle& lepton2) {
+const DileptonSearchStatus findPairLeptons(const vector<GenParticle>& genParticles, const GenParticle*& lepton1, const GenParticle*& lepton2) {
 
-    vector<GenParticle> leptons = vector<GenParticle>();
+    // slots for electrons, muons and taus, only the first two leptons of a flavour are kept but all are counted
+    const GenParticle* leptons[3][2] = {{nullptr, nullptr}, {nullptr, nullptr}, {nullptr, nullptr}};
+    size_t nLeptons[3] = {0, 0, 0};
     for (const GenParticle& genParticle : genParticles) {
+        const int pdgId = abs(genParticle.pdgId());
+        if ((pdgId != 11) && (pdgId != 13) && (pdgId != 15)) {
+            continue;
+        }
         const GenStatusFlags statusFlags = genParticle.statusFlags();
-        if (
-            (abs(genParticle.pdgId()) == pdgIdLepton) &&
-            (statusFlags.isHardProcess()) &&
-            (statusFlags.isFirstCopy())
-        ) {
-            leptons.push_back(genParticle);
+        if (!(statusFlags.isHardProcess() && statusFlags.isFirstCopy())) {
+            continue;
+        }
+        const size_t flavour = (pdgId - 11) / 2;
+        if (nLeptons[flavour] < 2) {
+            leptons[flavour][nLeptons[flavour]] = &genParticle;
         }
+        ++nLeptons[flavour];
     }
 
-    if (leptons.size() == 2 && (leptons.at(0).charge() * leptons.at(1).charge() == -1)) {
-        lepton1 = leptons.at(0);
-        lepton2 = leptons.at(1);
-        return true;
+    return selectPairLeptons(
+        nLeptons,
+        leptons,
+        [] (const GenParticle* l1, const GenParticle* l2) { return l1->charge() * l2->charge(); },
+        lepton1,
+        lepton2
+    );
+}
+
+
+const DileptonSearchStatus findPairLeptons(const GenDecayTree& tree, uint32_t& lepton1, uint32_t& lepton2) {
+    const vector<int>& pdgIds = tree.pdgIds();
+    const vector<int>& charges = tree.charges();
+    const vector<uint16_t>& statusFlags = tree.statusFlags();
+    const uint16_t requiredFlags = (1 << GenStatusFlags::kIsHardProcess) | (1 << GenStatusFlags::kIsFirstCopy);
+
+    uint32_t leptons[3][2] = {{0, 0}, {0, 0}, {0, 0}};
+    size_t nLeptons[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < tree.size(); ++i) {
+        const int pdgId = abs(pdgIds[i]);
+        if (((pdgId != 11) && (pdgId != 13) && (pdgId != 15)) || ((statusFlags[i] & requiredFlags) != requiredFlags)) {
+            continue;
+        }
+        const size_t flavour = (pdgId - 11) / 2;
+        if (nLeptons[flavour] < 2) {
+            leptons[flavour][nLeptons[flavour]] = i;
+        }
+        ++nLeptons[flavour];
     }
 
-    return false;
+    return selectPairLeptons(
+        nLeptons,
+        leptons,
+        [&charges] (const uint32_t& l1, const uint32_t& l2) { return charges[l1] * charges[l2]; },
+        lepton1,
+        lepton2
+    );
 }
 
 
-const pair<GenParticle, GenParticle> getHZGammaLeptonPair(const GenParticle& motherParticle, const int& pdgIdLepton) {
-    int pdgId = abs(motherParticle.pdgId());
-    if ((pdgId != 22) && (pdgId != 23) && (pdgId != 25)) {
+const pair<const GenParticle*, const GenParticle*> getHZGammaLeptonPair(const GenParticle& motherParticle, const int& pdgIdLepton) {
+    if (!isHZGammaPdgId(motherParticle.pdgId())) {
         throw runtime_error("getHZGammaLeptonPair: mother particle is neither a Z nor a H boson");
     }
 
@@ -75,154 +285,197 @@ const pair<GenParticle, GenParticle> getHZGammaLeptonPair(const GenParticle& mot
         throw runtime_error("getHZGammaLeptonPair: malicious event, mother particle does not have exactly two daughters");
     }
 
-    vector<GenParticle> lepPair = vector<GenParticle>();
+    const GenParticle* lepPair[2] = {nullptr, nullptr};
+    size_t nLeptons = 0;
     for (unsigned int i = 0; i < nDaughters; ++i) {
-        const Candidate* daughter = motherParticle.daughter(i);
+        const GenParticleRef& daughter = motherParticle.daughterRef(i);
         if (abs(daughter->pdgId()) != pdgIdLepton) {
             continue;
         }
-        const GenParticle* genDaughter = dynamic_cast<const GenParticle*>(daughter);
-        lepPair.push_back(*genDaughter);
+        lepPair[nLeptons++] = daughter.get();
     }
     
-    if (lepPair.size() != 2) {
+    if (nLeptons != 2) {
         throw runtime_error("getHZGammaLeptonPair: search for lepton pair failed");
     }
 
-    return pair<GenParticle, GenParticle>(lepPair[0], lepPair[1]);
+    return pair<const GenParticle*, const GenParticle*>(lepPair[0], lepPair[1]);
 }
 
 
-const TauFinalState getTauFinalState(const GenParticle& motherParticle) {
-    int pdgId = abs(motherParticle.pdgId());
-    unsigned int nDaughters = motherParticle.numberOfDaughters();
+const pair<uint32_t, uint32_t> getHZGammaLeptonPair(const GenDecayTree& tree, const uint32_t& motherParticle, const int& pdgIdLepton) {
+    if (!isHZGammaPdgId(tree.pdgIds()[motherParticle])) {
+        throw runtime_error("getHZGammaLeptonPair: mother particle is neither a Z nor a H boson");
+    }
+
+    if (!tree.hasStatusFlag(motherParticle, GenStatusFlags::kIsLastCopy)) {
+        throw runtime_error("getHZGammaLeptonPair: mother particle is not a last copy");
+    }
+
+    const GenIndexRange daughters = tree.daughters(motherParticle);
+    if (daughters.size() != 2) {
+        throw runtime_error("getHZGammaLeptonPair: malicious event, mother particle does not have exactly two daughters");
+    }
+
+    if ((abs(tree.pdgIds()[daughters[0]]) != pdgIdLepton) || (abs(tree.pdgIds()[daughters[1]]) != pdgIdLepton)) {
+        throw runtime_error("getHZGammaLeptonPair: search for lepton pair failed");
+    }
 
-    if ((pdgId != 15)) {
+    return pair<uint32_t, uint32_t>(daughters[0], daughters[1]);
+}
+
+
+const TauFinalState getTauFinalState(const GenParticle& tau) {
+    if (abs(tau.pdgId()) != 15) {
         throw runtime_error("getTauFinalState: mother particle is not a tau lepton");
     } 
-    
-    if ((pdgId == 15) && !(motherParticle.isLastCopy())) {
-        for (unsigned int i = 0; i < nDaughters; ++i) {
-            const Candidate* daughter = motherParticle.daughter(i);
-            const GenParticle* genDaughter = dynamic_cast<const GenParticle*>(daughter);
-            if (abs(genDaughter->pdgId()) != 15) {
-                continue;
-            }
-            return getTauFinalState(*genDaughter);
-        }
+
+    // the decay products are attached to the last copy of the tau
+    TauDecayCounts counts = TauDecayCounts{0, 0, 0, 0, 0};
+    for (const GenParticleRef& daughter : getDirectDaughters(tau)) {
+        counts.add(daughter->pdgId());
     }
 
-    int nEle = 0;
-    int nNuEle = 0;
-    int nMu = 0;
-    int nNuMu = 0;
-    int nNuTau = 0;
+    return classifyTauDecay(counts);
+}
 
-    for (unsigned int i = 0; i < nDaughters; ++i) {
-        const Candidate* daughter = motherParticle.daughter(i);
-        int pdgIdDau = abs(daughter->pdgId());
-        if (pdgIdDau == 11) {
-            nEle++;
-        } else if (pdgIdDau == 12) {
-            nNuEle++;
-        } else if (pdgIdDau == 13) {
-            nMu++;
-        } else if (pdgIdDau == 14) {
-            nNuMu++;
-        } else if (pdgIdDau == 16) {
-            nNuTau++;
-        }
+
+const TauFinalState getTauFinalState(const GenDecayTree& tree, const uint32_t& tau) {
+    if (abs(tree.pdgIds()[tau]) != 15) {
+        throw runtime_error("getTauFinalState: mother particle is not a tau lepton");
+    } 
+
+    TauDecayCounts counts = TauDecayCounts{0, 0, 0, 0, 0};
+    for (const uint32_t daughter : getDirectDaughters(tree, tau)) {
+        counts.add(tree.pdgIds()[daughter]);
     }
 
-    // get tau decay mode
-    if ((nEle == 1) && (nNuEle == 1) && (nMu == 0) && (nNuMu == 0) && (nNuTau == 1)) {
-        return TauFinalState::tauToE;
+    return classifyTauDecay(counts);
+}
+
+
+const int getTauDecayMode(const GenParticle& tau) {
+    if (abs(tau.pdgId()) != 15) {
+        throw runtime_error("getTauDecayMode: mother particle is not a tau lepton");
     }
-    if ((nEle == 0) && (nNuEle == 0) && (nMu == 1) && (nNuMu == 1) && (nNuTau == 1)) {
-        return TauFinalState::tauToM;
-    } 
-    if ((nEle == 0) && (nNuEle == 0) && (nMu == 0) && (nNuMu == 0) && (nNuTau == 1)) {
-        return TauFinalState::tauToT;
-    } 
 
-    // if none of the above is true, the decay mode is unknown
-    return TauFinalState::tauToUnknown;
+    int nChargedLeptons = 0;
+    int nChargedHadrons = 0;
+    int nPi0 = 0;
+    for (const GenParticleRef& daughter : getDirectDaughters(tau)) {
+        countTauDecayProduct(daughter->pdgId(), daughter->charge(), nChargedLeptons, nChargedHadrons, nPi0);
+    }
+
+    return classifyTauDecayMode(nChargedLeptons, nChargedHadrons, nPi0);
 }
 
 
-const HZGammaFinalState getDileptonFinalState(const GenParticle& lepton1, const GenParticle& lepton2) {
-    int nEle = 0;
-    int nMu = 0;
-    int nTau = 0;
+const int getTauDecayMode(const GenDecayTree& tree, const uint32_t& tau) {
+    if (abs(tree.pdgIds()[tau]) != 15) {
+        throw runtime_error("getTauDecayMode: mother particle is not a tau lepton");
+    }
 
-    vector<GenParticle> leptons = vector<GenParticle>({lepton1, lepton2});
+    int nChargedLeptons = 0;
+    int nChargedHadrons = 0;
+    int nPi0 = 0;
+    for (const uint32_t daughter : getDirectDaughters(tree, tau)) {
+        countTauDecayProduct(tree.pdgIds()[daughter], tree.charges()[daughter], nChargedLeptons, nChargedHadrons, nPi0);
+    }
 
-    for (const GenParticle& lepton : leptons) {
-        int pdgId = abs(lepton.pdgId());
-        if (pdgId == 11) {
-            nEle++;
-        } else if (pdgId == 13) {
-            nMu++;
-        } else if (pdgId == 15) {
-            nTau++;
-        }
+    return classifyTauDecayMode(nChargedLeptons, nChargedHadrons, nPi0);
+}
+
+
+const GenTauDecay getLeptonDecay(const GenParticle& lepton) {
+    const int absPdgId = abs(lepton.pdgId());
+    if ((absPdgId == 11) || (absPdgId == 13)) {
+        return GenTauDecay{TauFinalState::tauToUnknown, -1, getLastCopy(lepton).p4(), math::XYZTLorentzVector()};
+    }
+    if (absPdgId != 15) {
+        throw runtime_error("getLeptonDecay: particle is not a charged lepton");
+    }
+
+    GenTauDecay decay = GenTauDecay{TauFinalState::tauToUnknown, -1, math::XYZTLorentzVector(), math::XYZTLorentzVector()};
+    TauDecayCounts counts = TauDecayCounts{0, 0, 0, 0, 0};
+    int nChargedLeptons = 0;
+    int nChargedHadrons = 0;
+    int nPi0 = 0;
+    for (const GenParticleRef& daughter : getDirectDaughters(lepton)) {
+        counts.add(daughter->pdgId());
+        countTauDecayProduct(daughter->pdgId(), daughter->charge(), nChargedLeptons, nChargedHadrons, nPi0);
+        addTauDecayProduct(daughter->pdgId(), daughter->p4(), decay);
+    }
+    decay.finalState = classifyTauDecay(counts);
+    decay.decayMode = classifyTauDecayMode(nChargedLeptons, nChargedHadrons, nPi0);
+
+    return decay;
+}
+
+
+const GenTauDecay getLeptonDecay(const GenDecayTree& tree, const vector<GenParticle>& genParticles, const uint32_t& lepton) {
+    const int absPdgId = abs(tree.pdgIds()[lepton]);
+    if ((absPdgId == 11) || (absPdgId == 13)) {
+        return GenTauDecay{TauFinalState::tauToUnknown, -1, genParticles.at(tree.lastCopy(lepton)).p4(), math::XYZTLorentzVector()};
+    }
+    if (absPdgId != 15) {
+        throw runtime_error("getLeptonDecay: particle is not a charged lepton");
+    }
+
+    GenTauDecay decay = GenTauDecay{TauFinalState::tauToUnknown, -1, math::XYZTLorentzVector(), math::XYZTLorentzVector()};
+    TauDecayCounts counts = TauDecayCounts{0, 0, 0, 0, 0};
+    int nChargedLeptons = 0;
+    int nChargedHadrons = 0;
+    int nPi0 = 0;
+    for (const uint32_t daughter : getDirectDaughters(tree, lepton)) {
+        counts.add(tree.pdgIds()[daughter]);
+        countTauDecayProduct(tree.pdgIds()[daughter], tree.charges()[daughter], nChargedLeptons, nChargedHadrons, nPi0);
+        addTauDecayProduct(tree.pdgIds()[daughter], genParticles.at(daughter).p4(), decay);
     }
+    decay.finalState = classifyTauDecay(counts);
+    decay.decayMode = classifyTauDecayMode(nChargedLeptons, nChargedHadrons, nPi0);
+
+    return decay;
+}
+
+
+const HZGammaFinalState getTauPairFinalState(const TauFinalState& tauFinalState1, const TauFinalState& tauFinalState2) {
+    const TauFinalState tauFinalStates[2] = {tauFinalState1, tauFinalState2};
+    return classifyTauPair(tauFinalStates);
+}
+
+
+const HZGammaFinalState getDileptonFinalState(const GenParticle& lepton1, const GenParticle& lepton2) {
+    const int pdgId1 = abs(lepton1.pdgId());
+    const int pdgId2 = abs(lepton2.pdgId());
 
     // get Z -> ee and Z -> mu mu decays
-    if ((nEle == 2) && (nMu == 0) && (nTau == 0)) {
-        return HZGammaFinalState::eePrompt;
-    } 
-    if ((nEle == 0) && (nMu == 2) && (nTau == 0)) {
-        return HZGammaFinalState::mmPrompt;
+    const HZGammaFinalState promptFinalState = classifyPromptPair(pdgId1, pdgId2);
+    if (promptFinalState != HZGammaFinalState::unknown) {
+        return promptFinalState;
     }
 
     // further examine Z -> tautau decays
-    pair<GenParticle, GenParticle> tauTauPair = pair<GenParticle, GenParticle>({lepton1, lepton2});
-    const TauFinalState tauFinalState1 = getTauFinalState(tauTauPair.first);
-    const TauFinalState tauFinalState2 = getTauFinalState(tauTauPair.second);
-    vector<TauFinalState> tauFinalStates = vector<TauFinalState>({tauFinalState1, tauFinalState2});
-
-    vector<pair<size_t, size_t>> indexPairs = vector<pair<size_t, size_t>>({
-        pair<size_t, size_t>({0, 1}),
-        pair<size_t, size_t>({1, 0})
-    });
-    for (size_t i = 0; i < indexPairs.size(); ++i) {
+    return getTauPairFinalState(getTauFinalState(lepton1), getTauFinalState(lepton2));
+}
 
-        size_t i1 = indexPairs[i].first;
-        size_t i2 = indexPairs[i].second;
 
-        if ((tauFinalStates[i1] == TauFinalState::tauToUnknown) || (tauFinalStates[i2] == TauFinalState::tauToUnknown)) {
-            return HZGammaFinalState::unknown;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::et;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToM) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::mt;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToT) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::tt;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToE)) {
-            return HZGammaFinalState::ee;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToM) || (tauFinalStates[i2] == TauFinalState::tauToM)) {
-            return HZGammaFinalState::mm;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToM)) {
-            return HZGammaFinalState::em;
-        }
+const HZGammaFinalState getDileptonFinalState(const GenDecayTree& tree, const uint32_t& lepton1, const uint32_t& lepton2) {
+    const int pdgId1 = abs(tree.pdgIds()[lepton1]);
+    const int pdgId2 = abs(tree.pdgIds()[lepton2]);
 
+    // get Z -> ee and Z -> mu mu decays
+    const HZGammaFinalState promptFinalState = classifyPromptPair(pdgId1, pdgId2);
+    if (promptFinalState != HZGammaFinalState::unknown) {
+        return promptFinalState;
     }
 
-    // if all decisions have been false up to here, the decay mode is not known
-    return HZGammaFinalState::unknown;
+    // further examine Z -> tautau decays
+    return getTauPairFinalState(getTauFinalState(tree, lepton1), getTauFinalState(tree, lepton2));
 }
 
 
 const HZGammaFinalState getHZGammaFinalState(const GenParticle& motherParticle) {
-    int pdgId = abs(motherParticle.pdgId());
-    if ((pdgId != 22) && (pdgId != 23) && (pdgId != 25)) {
+    if (!isHZGammaPdgId(motherParticle.pdgId())) {
         throw runtime_error("getHZGammaFinalState: mother particle is neither a Z nor a H boson");
     }
 
@@ -251,73 +504,74 @@ const HZGammaFinalState getHZGammaFinalState(const GenParticle& motherParticle)
     }
 
     // further examine Z -> tautau decays
-    pair<GenParticle, GenParticle> tauTauPair = getHZGammaLeptonPair(motherParticle, 15);
-    const TauFinalState tauFinalState1 = getTauFinalState(tauTauPair.first);
-    const TauFinalState tauFinalState2 = getTauFinalState(tauTauPair.second);
-    vector<TauFinalState> tauFinalStates = vector<TauFinalState>({tauFinalState1, tauFinalState2});
+    const pair<const GenParticle*, const GenParticle*> tauTauPair = getHZGammaLeptonPair(motherParticle, 15);
+    return getTauPairFinalState(getTauFinalState(*tauTauPair.first), getTauFinalState(*tauTauPair.second));
+}
 
-    vector<pair<size_t, size_t>> indexPairs = vector<pair<size_t, size_t>>({
-        pair<size_t, size_t>({0, 1}),
-        pair<size_t, size_t>({1, 0})
-    });
-    for (size_t i = 0; i < indexPairs.size(); ++i) {
 
-        size_t i1 = indexPairs[i].first;
-        size_t i2 = indexPairs[i].second;
+const HZGammaFinalState getHZGammaFinalState(const GenDecayTree& tree, const uint32_t& motherParticle) {
+    if (!isHZGammaPdgId(tree.pdgIds()[motherParticle])) {
+        throw runtime_error("getHZGammaFinalState: mother particle is neither a Z nor a H boson");
+    }
 
-        if ((tauFinalStates[i1] == TauFinalState::tauToUnknown) || (tauFinalStates[i2] == TauFinalState::tauToUnknown)) {
-            return HZGammaFinalState::unknown;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::et;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToM) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::mt;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToT) || (tauFinalStates[i2] == TauFinalState::tauToT)) {
-            return HZGammaFinalState::tt;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToE)) {
-            return HZGammaFinalState::ee;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToM) || (tauFinalStates[i2] == TauFinalState::tauToM)) {
-            return HZGammaFinalState::mm;
-        }
-        if ((tauFinalStates[i1] == TauFinalState::tauToE) || (tauFinalStates[i2] == TauFinalState::tauToM)) {
-            return HZGammaFinalState::em;
+    int nEle = 0;
+    int nMu = 0;
+    int nTau = 0;
+
+    for (const uint32_t daughter : tree.daughters(motherParticle)) {
+        int pdgIdDau = abs(tree.pdgIds()[daughter]);
+        if (pdgIdDau == 11) {
+            nEle++;
+        } else if (pdgIdDau == 13) {
+            nMu++;
+        } else if (pdgIdDau == 15) {
+            nTau++;
         }
+    }
 
+    // get Z -> ee and Z -> mu mu decays
+    if ((nEle == 2) && (nMu == 0) && (nTau == 0)) {
+        return HZGammaFinalState::eePrompt;
+    } 
+    if ((nEle == 0) && (nMu == 2) && (nTau == 0)) {
+        return HZGammaFinalState::mmPrompt;
     }
 
-    // if all decisions have been false up to here, the decay mode is not known
-    return HZGammaFinalState::unknown;
+    // further examine Z -> tautau decays
+    const pair<uint32_t, uint32_t> tauTauPair = getHZGammaLeptonPair(tree, motherParticle, 15);
+    return getTauPairFinalState(getTauFinalState(tree, tauTauPair.first), getTauFinalState(tree, tauTauPair.second));
 }
 
 
-const vector<GenParticle> getDirectDaughters(const GenParticle& motherParticle) {
-
-    if (!(motherParticle.isLastCopy())) {
-        for (unsigned int i = 0; i < motherParticle.numberOfDaughters(); ++i) {
-            const Candidate* daughter = motherParticle.daughter(i);
-            const GenParticle* genDaughter = dynamic_cast<const GenParticle*>(daughter);
-            if (abs(genDaughter->pdgId()) != abs(motherParticle.pdgId())) {
-                continue;
+const GenParticle& getLastCopy(const GenParticle& genParticle) {
+    const GenParticle* copy = &genParticle;
+    while (!copy->isLastCopy()) {
+        const GenParticle* nextCopy = nullptr;
+        for (const GenParticleRef& daughter : copy->daughterRefVector()) {
+            if (abs(daughter->pdgId()) == abs(copy->pdgId())) {
+                nextCopy = daughter.get();
+                break;
             }
-            return getDirectDaughters(*genDaughter);
         }
+        if (nextCopy == nullptr) {
+            break;
+        }
+        copy = nextCopy;
     }
+    return *copy;
+}
+
+
+const GenParticleRefVector& getDirectDaughters(const GenParticle& motherParticle) {
+    return getLastCopy(motherParticle).daughterRefVector();
+}
 
-    vector<GenParticle> daughters = vector<GenParticle>();
-    for (unsigned int i = 0; i < motherParticle.numberOfDaughters(); ++i) {
-        const Candidate* daughter = motherParticle.daughter(i);
-        const GenParticle* genDaughter = dynamic_cast<const GenParticle*>(daughter);
-        daughters.push_back(*genDaughter);
-    }
 
-    return daughters;
+const GenIndexRange getDirectDaughters(const GenDecayTree& tree, const uint32_t& motherParticle) {
+    return tree.daughters(tree.lastCopy(motherParticle));
 }
 
 
 }; // end namespace tautau_selection_gen
 
-# endif // end GUARD_TAUTAUPAIRALGORITHM_H
\ No newline at end of file
+# endif // end GUARD_TAUTAUPAIRALGORITHM_H
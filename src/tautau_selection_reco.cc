@@ -1,10 +1,16 @@
 // system include files
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
 // user include files
 #include "DataFormats/PatCandidates/interface/Electron.h"
 #include "DataFormats/PatCandidates/interface/Muon.h"
 #include "DataFormats/PatCandidates/interface/Tau.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
 
 #include "Math/Vector4D.h"
 
@@ -20,33 +26,188 @@ using namespace util;
 namespace tautau_selection_reco {
 
 
-const bool comparePairs(const pair<SortScore, SortScore>& prevPair,  const pair<SortScore, SortScore>& nextPair) {
-    const SortScore prevDauOne = prevPair.first;
-    const SortScore prevDauTwo = prevPair.second;
-    const SortScore nextDauOne = nextPair.first;
-    const SortScore nextDauTwo = nextPair.second;
+// order preserving map of a score to 32 bits, see getSortKey
+static const uint32_t quantizeScore(const double& score) {
+    // adding zero turns -0 into +0, so that both share a key
+    const float rounded = reduceMantissa<17>(static_cast<float>(score)) + 0.f;
+    uint32_t word;
+    memcpy(&word, &rounded, sizeof(word));
+    // flip all bits of negative and the sign bit of positive values, so that the words compare like the floats
+    return (word & 0x80000000u) ? ~word : (word | 0x80000000u);
+}
+
+
+const uint64_t getSortKey(const SortScore& sortScore) {
+    return (static_cast<uint64_t>(quantizeScore(sortScore.isoScore)) << 32) | quantizeScore(sortScore.ptScore);
+}
+
+
+// tau ID working points that are required for the tau legs in the three final states
+static const uint32_t idBitsET = (1u << TauIDBit::byTightDeepTau2017v2p1VSe) | (1u << TauIDBit::byVLooseDeepTau2017v2p1VSmu) | (1u << TauIDBit::byTightDeepTau2017v2p1VSjet);
+static const uint32_t idBitsMT = (1u << TauIDBit::byVVLooseDeepTau2017v2p1VSe) | (1u << TauIDBit::byTightDeepTau2017v2p1VSmu) | (1u << TauIDBit::byTightDeepTau2017v2p1VSjet);
+static const uint32_t idBitsTT = (1u << TauIDBit::byVVLooseDeepTau2017v2p1VSe) | (1u << TauIDBit::byVLooseDeepTau2017v2p1VSmu) | (1u << TauIDBit::byTightDeepTau2017v2p1VSjet);
+
+// tau ID working points that are required in the preselection of the taus
+static const uint32_t idBitsPreselection = (1u << TauIDBit::byVVLooseDeepTau2017v2p1VSe) | (1u << TauIDBit::byVLooseDeepTau2017v2p1VSmu) | (1u << TauIDBit::byMediumDeepTau2017v2p1VSjet);
+
+
+TauIDResolver::TauIDResolver() {
+    indices_ = vector<size_t>();
+}
+
+
+const vector<string>& TauIDResolver::getNames() {
+    // the working points in the order of TauIDBit, followed by the raw score
+    static const vector<string> names = {
+        "byVVLooseDeepTau2017v2p1VSe",
+        "byTightDeepTau2017v2p1VSe",
+        "byVLooseDeepTau2017v2p1VSmu",
+        "byTightDeepTau2017v2p1VSmu",
+        "byTightDeepTau2017v2p1VSjet",
+        "byMediumDeepTau2017v2p1VSjet",
+        "byDeepTau2017v2p1VSjetraw"
+    };
+    return names;
+}
+
+
+void TauIDResolver::update(const Tau& tau) {
+    const vector<string>& names = getNames();
+    const vector<Tau::IdPair>& tauIDs = tau.tauIDs();
+
+    // keep the positions if the layout of the list is unchanged
+    bool isResolved = (indices_.size() == names.size());
+    for (size_t i = 0; isResolved && (i < names.size()); ++i) {
+        isResolved = (indices_[i] < tauIDs.size()) && (tauIDs[indices_[i]].first == names[i]);
+    }
+    if (isResolved) {
+        return;
+    }
 
-    // compare isolation of the first objects in the pair
-    if (!approxEqual(prevDauOne.isoScore, nextDauOne.isoScore)) {
-        return prevDauOne.isoScore > nextDauOne.isoScore;
+    indices_.clear();
+    for (const string& name : names) {
+        size_t index = 0;
+        while ((index < tauIDs.size()) && (tauIDs[index].first != name)) {
+            ++index;
+        }
+        if (index == tauIDs.size()) {
+            throw runtime_error("TauIDResolver: tau ID '" + name + "' is not available");
+        }
+        indices_.push_back(index);
     }
+}
 
-    // compare the pt of the first objects in the pair
-    if (!approxEqual(prevDauOne.ptScore, nextDauOne.ptScore)) {
-        return prevDauOne.ptScore > nextDauOne.ptScore;
+
+const uint32_t TauIDResolver::getIDBits(const Tau& tau) const {
+    const vector<Tau::IdPair>& tauIDs = tau.tauIDs();
+    uint32_t idBits = 0;
+    for (size_t i = 0; i + 1 < indices_.size(); ++i) {
+        idBits |= static_cast<uint32_t>(tauIDs.at(indices_[i]).second > 0.5) << i;
     }
+    return idBits;
+}
+
 
-    // compare isolation of the second objects in the pair
-    if (!approxEqual(prevDauTwo.isoScore, nextDauTwo.isoScore)) {
-        return prevDauTwo.isoScore > nextDauTwo.isoScore;
+const float TauIDResolver::getDeepTauVSjetRaw(const Tau& tau) const {
+    return tau.tauIDs().at(indices_.back()).second;
+}
+
+
+TauTauPreselector::TauTauPreselector(const edm::ParameterSet& pset) {
+    const edm::ParameterSet& electronSelection = pset.getParameter<edm::ParameterSet>("electronSelection");
+    electronCuts_ = getLeptonCuts(electronSelection);
+    electronID_ = electronSelection.getParameter<string>("electronID");
+
+    muonCuts_ = getLeptonCuts(pset.getParameter<edm::ParameterSet>("muonSelection"));
+
+    const edm::ParameterSet& tauSelection = pset.getParameter<edm::ParameterSet>("tauSelection");
+    tauPtMin_ = tauSelection.getParameter<double>("ptMin");
+    tauEtaMax_ = tauSelection.getParameter<double>("etaMax");
+    tauDecayModes_ = tauSelection.getParameter<vector<int>>("decayModes");
+}
+
+
+const LeptonCuts TauTauPreselector::getLeptonCuts(const edm::ParameterSet& pset) {
+    return LeptonCuts{
+        pset.getParameter<double>("ptMin"),
+        pset.getParameter<double>("vetoPtMin"),
+        pset.getParameter<double>("etaMax"),
+        pset.getParameter<double>("dxyMax"),
+        pset.getParameter<double>("dzMax"),
+        pset.getParameter<double>("relIsoMax"),
+        pset.getParameter<double>("vetoRelIsoMax")
+    };
+}
+
+
+void TauTauPreselector::select(
+    const vector<Electron>& electrons,
+    const vector<Muon>& muons,
+    const vector<Tau>& taus,
+    const TauIDResolver& tauIDResolver,
+    TauTauPreselection& preselection
+) const {
+    preselection.electrons.clear();
+    preselection.vetoElectrons.clear();
+    for (uint32_t i = 0; i < electrons.size(); ++i) {
+        const Electron& electron = electrons[i];
+        const double pt = electron.pt();
+        if (
+            ((pt <= electronCuts_.ptMin) && (pt <= electronCuts_.vetoPtMin))
+            || (abs(electron.eta()) >= electronCuts_.etaMax)
+            || (abs(electron.dB(Electron::PV2D)) >= electronCuts_.dxyMax)
+            || (abs(electron.dB(Electron::PVDZ)) >= electronCuts_.dzMax)
+            || (electron.electronID(electronID_) <= 0.5)
+        ) {
+            continue;
+        }
+        const double relIso = electron.userFloat("PFIsoAll") / pt;
+        if ((pt > electronCuts_.ptMin) && (relIso < electronCuts_.relIsoMax)) {
+            preselection.electrons.push_back(i);
+        }
+        if ((pt > electronCuts_.vetoPtMin) && (relIso < electronCuts_.vetoRelIsoMax)) {
+            preselection.vetoElectrons.push_back(i);
+        }
     }
 
-    // compare the pt of the second objects in the pair
-    if (!approxEqual(prevDauTwo.ptScore, nextDauTwo.ptScore)) {
-        return prevDauTwo.ptScore > nextDauTwo.ptScore;
+    preselection.muons.clear();
+    preselection.vetoMuons.clear();
+    for (uint32_t i = 0; i < muons.size(); ++i) {
+        const Muon& muon = muons[i];
+        const double pt = muon.pt();
+        if (
+            ((pt <= muonCuts_.ptMin) && (pt <= muonCuts_.vetoPtMin))
+            || (abs(muon.eta()) >= muonCuts_.etaMax)
+            || (abs(muon.dB(Muon::PV2D)) >= muonCuts_.dxyMax)
+            || (abs(muon.dB(Muon::PVDZ)) >= muonCuts_.dzMax)
+            || !muon.isMediumMuon()
+        ) {
+            continue;
+        }
+        const double relIso = (
+            muon.pfIsolationR04().sumChargedHadronPt +
+            max(muon.pfIsolationR04().sumNeutralHadronEt + muon.pfIsolationR04().sumPhotonEt - 0.5 * muon.pfIsolationR04().sumPUPt, 0.0)
+        ) / pt;
+        if ((pt > muonCuts_.ptMin) && (relIso < muonCuts_.relIsoMax)) {
+            preselection.muons.push_back(i);
+        }
+        if ((pt > muonCuts_.vetoPtMin) && (relIso < muonCuts_.vetoRelIsoMax)) {
+            preselection.vetoMuons.push_back(i);
+        }
     }
 
-    return false;
+    preselection.taus.clear();
+    for (uint32_t i = 0; i < taus.size(); ++i) {
+        const Tau& tau = taus[i];
+        if (
+            (tau.pt() > tauPtMin_)
+            && (abs(tau.eta()) < tauEtaMax_)
+            && (find(tauDecayModes_.begin(), tauDecayModes_.end(), tau.decayMode()) != tauDecayModes_.end())
+            && ((tauIDResolver.getIDBits(tau) & idBitsPreselection) == idBitsPreselection)
+        ) {
+            preselection.taus.push_back(i);
+        }
+    }
 }
 
 
@@ -54,24 +215,27 @@ TauTauPairAlgorithm::TauTauPairAlgorithm(
     const vector<Electron>& electrons,
     const vector<Muon>& muons,
     const vector<Tau>& taus,
-    const vector<Electron>& vetoElectrons,
-    const vector<Muon>& vetoMuons
-) {
-    electrons_ = electrons;
-    muons_ = muons;
-    taus_ = taus;
-    vetoElectrons_ = vetoElectrons;
-    vetoMuons_ = vetoMuons;
-
+    const TauTauPreselection& preselection,
+    const TauIDResolver& tauIDResolver,
+    TauTauPairWorkspace& workspace
+) :
+    electrons_(electrons),
+    muons_(muons),
+    taus_(taus),
+    preselection_(preselection),
+    tauIDResolver_(tauIDResolver),
+    workspace_(workspace)
+{
     hasBeenExecuted_ = false;
     finalState_ = TauTauFinalState::unknown;
-    pair<Electron, Tau> etPair_;
-    pair<Muon, Tau> mtPair_;
-    pair<Tau, Tau> ttPair_;   
+    pairIndices_ = pair<size_t, size_t>(0, 0);
+    pairSortScores_ = pair<SortScore, SortScore>(SortScore{0., 0.}, SortScore{0., 0.});
 }
 
 
 void TauTauPairAlgorithm::execute() {
+    computeFeatures();
+
     // execute the pair finding algorithm for the three considered final states
     const bool foundET = findPairET();
     const bool foundMT = findPairMT();
@@ -105,87 +269,145 @@ const TauTauFinalState TauTauPairAlgorithm::getFinalState() const {
 }
 
 
-const pair<Electron, Tau> TauTauPairAlgorithm::getPairET() const {
+const pair<size_t, size_t> TauTauPairAlgorithm::getPairIndices() const {
+    if (!hasBeenExecuted_) {
+        throw runtime_error("TauTauPairAlgorithm: algorithm has not been run with execute() method");
+    }
+    if (finalState_ == TauTauFinalState::unknown) {
+        throw runtime_error("TauTauPairAlgorithm: trying to get pair indices in event without tau tau pair");
+    }
+    return pairIndices_;
+}
+
+
+const pair<SortScore, SortScore> TauTauPairAlgorithm::getPairSortScores() const {
+    if (!hasBeenExecuted_) {
+        throw runtime_error("TauTauPairAlgorithm: algorithm has not been run with execute() method");
+    }
+    if (finalState_ == TauTauFinalState::unknown) {
+        throw runtime_error("TauTauPairAlgorithm: trying to get pair sort scores in event without tau tau pair");
+    }
+    return pairSortScores_;
+}
+
+
+const pair<const Electron&, const Tau&> TauTauPairAlgorithm::getPairET() const {
     if (!hasBeenExecuted_) {
         throw runtime_error("TauTauPairAlgorithm: algorithm has not been run with execute() method");
     }
     if (!(finalState_ == TauTauFinalState::et)) {
         throw runtime_error("TauTauPairAlgorithm: trying to get electron-tau pair in event with final state different from electron-tau");
     }
-    return etPair_;
+    return pair<const Electron&, const Tau&>(electrons_[pairIndices_.first], taus_[pairIndices_.second]);
 }
 
 
-const pair<Muon, Tau> TauTauPairAlgorithm::getPairMT() const {
+const pair<const Muon&, const Tau&> TauTauPairAlgorithm::getPairMT() const {
     if (!hasBeenExecuted_) {
         throw runtime_error("TauTauPairAlgorithm: algorithm has not been run with execute() method");
     }
     if (!(finalState_ == TauTauFinalState::mt)) {
         throw runtime_error("TauTauPairAlgorithm: trying to get muon-tau pair in event with final state different from muon-tau");
     }
-    return mtPair_;
+    return pair<const Muon&, const Tau&>(muons_[pairIndices_.first], taus_[pairIndices_.second]);
 }
 
 
-const pair<Tau, Tau> TauTauPairAlgorithm::getPairTT() const {
+const pair<const Tau&, const Tau&> TauTauPairAlgorithm::getPairTT() const {
     if (!hasBeenExecuted_) {
         throw runtime_error("TauTauPairAlgorithm: algorithm has not been run with execute() method");
     }
     if (!(finalState_ == TauTauFinalState::tt)) {
         throw runtime_error("TauTauPairAlgorithm: trying to get muon-tau pair in event with final state different from muon-tau");
     }
-    return ttPair_;
+    return pair<const Tau&, const Tau&>(taus_[pairIndices_.first], taus_[pairIndices_.second]);
+}
+
+
+void TauTauPairAlgorithm::computeFeatures() {
+    workspace_.electronFeatures.clear();
+    for (const uint32_t index : preselection_.electrons) {
+        const Electron& electron = electrons_[index];
+        const double isoScore = -electron.userFloat("PFIsoAll");
+        const uint64_t sortKey = getSortKey(SortScore{isoScore, electron.pt()});
+        workspace_.electronFeatures.push_back(PairLegFeatures{index, 0, isoScore, electron.pt(), 0., electron.charge(), sortKey});
+    }
+
+    workspace_.muonFeatures.clear();
+    for (const uint32_t index : preselection_.muons) {
+        const Muon& muon = muons_[index];
+        const double muonIso = (
+            muon.pfIsolationR04().sumChargedHadronPt +
+            max(muon.pfIsolationR04().sumNeutralHadronEt + muon.pfIsolationR04().sumPhotonEt - 0.5 * muon.pfIsolationR04().sumPUPt, 0.0)
+        ) / muon.pt();
+        const uint64_t sortKey = getSortKey(SortScore{-muonIso, muon.pt()});
+        workspace_.muonFeatures.push_back(PairLegFeatures{index, 0, -muonIso, muon.pt(), 0., muon.charge(), sortKey});
+    }
+
+    // the taus enter all final states, their kinematics are laid out once for the batched delta R computations
+    workspace_.tauFeatures.clear();
+    workspace_.tauKinematics.clear();
+    for (const uint32_t index : preselection_.taus) {
+        const Tau& tau = taus_[index];
+        const PackedCandidate* leadChargedHadrCand = dynamic_cast<const PackedCandidate*>(tau.leadChargedHadrCand().get());
+        const float dz = leadChargedHadrCand ? abs(leadChargedHadrCand->dz()) : 0.;
+        const double isoScore = tauIDResolver_.getDeepTauVSjetRaw(tau);
+        const uint64_t sortKey = getSortKey(SortScore{isoScore, tau.pt()});
+        workspace_.tauFeatures.push_back(PairLegFeatures{index, tauIDResolver_.getIDBits(tau), isoScore, tau.pt(), dz, tau.charge(), sortKey});
+        workspace_.tauKinematics.push_back(tau);
+    }
 }
 
 
 const bool TauTauPairAlgorithm::findPairET() {
-    vector<pair<size_t, size_t>> pairIndex = vector<pair<size_t, size_t>>();
-    vector<pair<SortScore, SortScore>> pairSortScore = vector<pair<SortScore, SortScore>>();
-
-    // find pairs that fulfill the charge, the ID and the deltaR requirements
-    for (size_t iEle = 0; iEle < electrons_.size(); ++iEle) {
-        const Electron& electron = electrons_[iEle];
-        for (size_t iTau = 0; iTau < taus_.size(); ++iTau) {
-            const Tau& tau = taus_[iTau];
-            const PackedCandidate* leadChargedHadrCand = dynamic_cast<const PackedCandidate*>(tau.leadChargedHadrCand().get());
-            const float dz = leadChargedHadrCand ? abs(leadChargedHadrCand->dz()) : 0.;
+    // check the vetoes before any pair is built
+    if (!((preselection_.vetoElectrons.size() == 1) && (preselection_.vetoMuons.size() == 0))) {
+        return false;
+    }
+
+    // keep the best pair that fulfills the charge, the ID and the deltaR requirements, the first one wins on equal keys
+    const vector<PairLegFeatures>& tauFeatures = workspace_.tauFeatures;
+    bool found = false;
+    pair<uint64_t, uint64_t> bestSortKeys;
+    pair<size_t, size_t> bestPositions;
+    for (size_t iEle = 0; iEle < workspace_.electronFeatures.size(); ++iEle) {
+        const PairLegFeatures& electronFeatures = workspace_.electronFeatures[iEle];
+        if (found && (electronFeatures.sortKey < bestSortKeys.first)) {
+            continue;
+        }
+        const Electron& electron = electrons_[electronFeatures.index];
+        deltaR2(electron.eta(), electron.phi(), workspace_.tauKinematics, workspace_.deltaR2);
+        for (size_t iTau = 0; iTau < tauFeatures.size(); ++iTau) {
             if (
-                (dz < 0.2)
-                && (electron.charge() * tau.charge() < 0)
-                && ((tau.tauID("byTightDeepTau2017v2p1VSe") > 0.5) && (tau.tauID("byVLooseDeepTau2017v2p1VSmu") > 0.5) && (tau.tauID("byTightDeepTau2017v2p1VSjet") > 0.5))
-                && (getDeltaR(electron.p4(), tau.p4()) > 0.5)
+                (tauFeatures[iTau].dz < 0.2)
+                && (electronFeatures.charge * tauFeatures[iTau].charge < 0)
+                && ((tauFeatures[iTau].idBits & idBitsET) == idBitsET)
+                && (workspace_.deltaR2[iTau] > 0.25)
             ) {
-                pairIndex.push_back(pair<size_t, size_t>(iEle, iTau));
-                pairSortScore.push_back(pair<SortScore, SortScore>({
-                    SortScore{-electron.userFloat("PFIsoAll"), electron.pt()},
-                    SortScore{tau.tauID("byDeepTau2017v2p1VSjetraw"), tau.pt()}
-                }));
+                const pair<uint64_t, uint64_t> sortKeys(electronFeatures.sortKey, tauFeatures[iTau].sortKey);
+                if (!found || (sortKeys > bestSortKeys)) {
+                    found = true;
+                    bestSortKeys = sortKeys;
+                    bestPositions = pair<size_t, size_t>(iEle, iTau);
+                }
             }
         }
     }
 
-    // sort the pairs
-    vector<size_t> indexSorted = vector<size_t>();
-    for (size_t i = 0; i < pairIndex.size(); ++i) {
-        indexSorted.push_back(i);
-    }
-    stable_sort(
-        indexSorted.begin(),
-        indexSorted.end(),
-        [&pairSortScore] (size_t i1, size_t i2) { return comparePairs(pairSortScore[i1], pairSortScore[i2]); }
-    );
-
-    // calculate vetoes
-    bool isVetoed = !((vetoElectrons_.size() == 1) && (vetoMuons_.size() == 0));
-
-    // return false if no valid tau tau pair has been found or the event is vetoed
-    if (indexSorted.size() == 0 || isVetoed) {
+    // return false if no valid tau tau pair has been found
+    if (!found) {
         return false;
     }
 
     // set final state and e-tau pair
+    const PairLegFeatures& firstFeatures = workspace_.electronFeatures[bestPositions.first];
+    const PairLegFeatures& secondFeatures = tauFeatures[bestPositions.second];
     finalState_ = TauTauFinalState::et;
-    etPair_ = pair<Electron, Tau>({electrons_[pairIndex[indexSorted[0]].first], taus_[pairIndex[indexSorted[0]].second]});
+    pairIndices_ = pair<size_t, size_t>(firstFeatures.index, secondFeatures.index);
+    pairSortScores_ = pair<SortScore, SortScore>({
+        SortScore{firstFeatures.isoScore, firstFeatures.pt},
+        SortScore{secondFeatures.isoScore, secondFeatures.pt}
+    });
 
     // return that algorithm has been run successfully
     return true;
@@ -193,57 +415,54 @@ const bool TauTauPairAlgorithm::findPairET() {
 
 
 const bool TauTauPairAlgorithm::findPairMT() {
-    vector<pair<size_t, size_t>> pairIndex = vector<pair<size_t, size_t>>();
-    vector<pair<SortScore, SortScore>> pairSortScore = vector<pair<SortScore, SortScore>>();
-
-    // find pairs that fulfill the charge, the ID and the deltaR requirements
-    for (size_t iMuon = 0; iMuon < muons_.size(); ++iMuon) {
-        const Muon& muon = muons_[iMuon];
-        for (size_t iTau = 0; iTau < taus_.size(); ++iTau) {
-            const Tau& tau = taus_[iTau];
-            const PackedCandidate* leadChargedHadrCand = dynamic_cast<const PackedCandidate*>(tau.leadChargedHadrCand().get());
-            const float dz = leadChargedHadrCand ? abs(leadChargedHadrCand->dz()) : 0.;
+    // check the vetoes before any pair is built
+    if (!((preselection_.vetoElectrons.size() == 0) && (preselection_.vetoMuons.size() == 1))) {
+        return false;
+    }
+
+    // keep the best pair that fulfills the charge, the ID and the deltaR requirements, the first one wins on equal keys
+    const vector<PairLegFeatures>& tauFeatures = workspace_.tauFeatures;
+    bool found = false;
+    pair<uint64_t, uint64_t> bestSortKeys;
+    pair<size_t, size_t> bestPositions;
+    for (size_t iMuon = 0; iMuon < workspace_.muonFeatures.size(); ++iMuon) {
+        const PairLegFeatures& muonFeatures = workspace_.muonFeatures[iMuon];
+        if (found && (muonFeatures.sortKey < bestSortKeys.first)) {
+            continue;
+        }
+        const Muon& muon = muons_[muonFeatures.index];
+        deltaR2(muon.eta(), muon.phi(), workspace_.tauKinematics, workspace_.deltaR2);
+        for (size_t iTau = 0; iTau < tauFeatures.size(); ++iTau) {
             if (
-                (dz < 0.2)
-                && (muon.charge() * tau.charge() < 0)
-                && ((tau.tauID("byVVLooseDeepTau2017v2p1VSe") > 0.5) && (tau.tauID("byTightDeepTau2017v2p1VSmu") > 0.5) && (tau.tauID("byTightDeepTau2017v2p1VSjet") > 0.5))
-                && (getDeltaR(muon.p4(), tau.p4()) > 0.5)
+                (tauFeatures[iTau].dz < 0.2)
+                && (muonFeatures.charge * tauFeatures[iTau].charge < 0)
+                && ((tauFeatures[iTau].idBits & idBitsMT) == idBitsMT)
+                && (workspace_.deltaR2[iTau] > 0.25)
             ) {
-                double muonIso = (
-                    muon.pfIsolationR04().sumChargedHadronPt +
-                    max(muon.pfIsolationR04().sumNeutralHadronEt + muon.pfIsolationR04().sumPhotonEt - 0.5 * muon.pfIsolationR04().sumPUPt, 0.0)
-                ) / muon.pt();
-                pairIndex.push_back(pair<size_t, size_t>(iMuon, iTau));
-                pairSortScore.push_back(pair<SortScore, SortScore>({
-                    SortScore{-muonIso, muon.pt()},
-                    SortScore{tau.tauID("byDeepTau2017v2p1VSjetraw"), tau.pt()}
-                }));
+                const pair<uint64_t, uint64_t> sortKeys(muonFeatures.sortKey, tauFeatures[iTau].sortKey);
+                if (!found || (sortKeys > bestSortKeys)) {
+                    found = true;
+                    bestSortKeys = sortKeys;
+                    bestPositions = pair<size_t, size_t>(iMuon, iTau);
+                }
             }
         }
     }
 
-    // sort the pairs
-    vector<size_t> indexSorted = vector<size_t>();
-    for (size_t i = 0; i < pairIndex.size(); ++i) {
-        indexSorted.push_back(i);
-    }
-    stable_sort(
-        indexSorted.begin(),
-        indexSorted.end(),
-        [&pairSortScore] (size_t i1, size_t i2) { return comparePairs(pairSortScore[i1], pairSortScore[i2]); }
-    );
-
-    // calculate vetoes
-    bool isVetoed = !((vetoElectrons_.size() == 0) && (vetoMuons_.size() == 1));
-
-    // return false if no valid tau tau pair has been found or the event is vetoed
-    if (indexSorted.size() == 0 || isVetoed) {
+    // return false if no valid tau tau pair has been found
+    if (!found) {
         return false;
     }
 
     // set final state and mu-tau pair
+    const PairLegFeatures& firstFeatures = workspace_.muonFeatures[bestPositions.first];
+    const PairLegFeatures& secondFeatures = tauFeatures[bestPositions.second];
     finalState_ = TauTauFinalState::mt;
-    mtPair_ = pair<Muon, Tau>({muons_[pairIndex[indexSorted[0]].first], taus_[pairIndex[indexSorted[0]].second]});
+    pairIndices_ = pair<size_t, size_t>(firstFeatures.index, secondFeatures.index);
+    pairSortScores_ = pair<SortScore, SortScore>({
+        SortScore{firstFeatures.isoScore, firstFeatures.pt},
+        SortScore{secondFeatures.isoScore, secondFeatures.pt}
+    });
 
     // return that algorithm has been run successfully
     return true;
@@ -251,66 +470,62 @@ const bool TauTauPairAlgorithm::findPairMT() {
 
 
 const bool TauTauPairAlgorithm::findPairTT() {
-    vector<pair<size_t, size_t>> pairIndex = vector<pair<size_t, size_t>>();
-    vector<pair<SortScore, SortScore>> pairSortScore = vector<pair<SortScore, SortScore>>();
-
-    // find pairs that fulfill the charge, the ID and the deltaR requirements
-    for (size_t iTau1 = 0; iTau1 < taus_.size(); ++iTau1) {
-        const Tau& tau1 = taus_[iTau1];
-        const PackedCandidate* leadChargedHadrCand1 = dynamic_cast<const PackedCandidate*>(tau1.leadChargedHadrCand().get());
-        const float dz1 = leadChargedHadrCand1 ? abs(leadChargedHadrCand1->dz()) : 0.;
-        if (dz1 >= 0.2) {
+    // check the vetoes before any pair is built
+    if (!((preselection_.vetoElectrons.size() == 0) && (preselection_.vetoMuons.size() == 0))) {
+        return false;
+    }
+
+    // keep the best pair that fulfills the charge, the ID and the deltaR requirements, the first one wins on equal keys
+    const vector<PairLegFeatures>& tauFeatures = workspace_.tauFeatures;
+    bool found = false;
+    pair<uint64_t, uint64_t> bestSortKeys;
+    pair<size_t, size_t> bestPositions;
+    for (size_t iTau1 = 0; iTau1 < tauFeatures.size(); ++iTau1) {
+        const PairLegFeatures& tau1Features = tauFeatures[iTau1];
+        if (
+            (tau1Features.dz >= 0.2)
+            || ((tau1Features.idBits & idBitsTT) != idBitsTT)
+            || (found && (tau1Features.sortKey < bestSortKeys.first))
+        ) {
             continue;
         }
-        for (size_t iTau2 = 0; iTau2 < taus_.size(); ++iTau2) {
-            if (iTau1 == iTau2) {
-                continue;
-            }
-            const Tau& tau2 = taus_[iTau2];
-            const PackedCandidate* leadChargedHadrCand2 = dynamic_cast<const PackedCandidate*>(tau2.leadChargedHadrCand().get());
-            const float dz2 = leadChargedHadrCand2 ? abs(leadChargedHadrCand2->dz()) : 0.;
+        deltaR2(workspace_.tauKinematics.eta[iTau1], workspace_.tauKinematics.phi[iTau1], workspace_.tauKinematics, workspace_.deltaR2);
+        for (size_t iTau2 = 0; iTau2 < tauFeatures.size(); ++iTau2) {
             if (
-                (dz2 < 0.2)
-                && (tau1.charge() * tau2.charge() < 0)
-                && ((tau1.tauID("byVVLooseDeepTau2017v2p1VSe") > 0.5) && (tau1.tauID("byVLooseDeepTau2017v2p1VSmu") > 0.5) && (tau1.tauID("byTightDeepTau2017v2p1VSjet") > 0.5))
-                && ((tau2.tauID("byVVLooseDeepTau2017v2p1VSe") > 0.5) && (tau2.tauID("byVLooseDeepTau2017v2p1VSmu") > 0.5) && (tau2.tauID("byTightDeepTau2017v2p1VSjet") > 0.5))
-                && (getDeltaR(tau1.p4(), tau2.p4()) > 0.5)
+                (iTau1 != iTau2)
+                && (tauFeatures[iTau2].dz < 0.2)
+                && (tau1Features.charge * tauFeatures[iTau2].charge < 0)
+                && ((tauFeatures[iTau2].idBits & idBitsTT) == idBitsTT)
+                && (workspace_.deltaR2[iTau2] > 0.25)
             ) {
-                pairIndex.push_back(pair<size_t, size_t>(iTau1, iTau2));
-                pairSortScore.push_back(pair<SortScore, SortScore>({
-                    SortScore{tau1.tauID("byDeepTau2017v2p1VSjetraw"), tau1.pt()},
-                    SortScore{tau2.tauID("byDeepTau2017v2p1VSjetraw"), tau2.pt()}
-                }));
+                const pair<uint64_t, uint64_t> sortKeys(tau1Features.sortKey, tauFeatures[iTau2].sortKey);
+                if (!found || (sortKeys > bestSortKeys)) {
+                    found = true;
+                    bestSortKeys = sortKeys;
+                    bestPositions = pair<size_t, size_t>(iTau1, iTau2);
+                }
             }
         }
     }
 
-    // sort the pairs
-    vector<size_t> indexSorted = vector<size_t>();
-    for (size_t i = 0; i < pairIndex.size(); ++i) {
-        indexSorted.push_back(i);
-    }
-    stable_sort(
-        indexSorted.begin(),
-        indexSorted.end(),
-        [&pairSortScore] (size_t i1, size_t i2) { return comparePairs(pairSortScore[i1], pairSortScore[i2]); }
-    );
-
-    // calculate vetoes
-    bool isVetoed = !((vetoElectrons_.size() == 0) && (vetoMuons_.size() == 0));
-
-    // return false if no valid tau tau pair has been found or the event is vetoed
-    if (indexSorted.size() == 0 || isVetoed) {
+    // return false if no valid tau tau pair has been found
+    if (!found) {
         return false;
     }
 
-    // set final state and mu-tau pair
+    // set final state and tau-tau pair
+    const PairLegFeatures& firstFeatures = tauFeatures[bestPositions.first];
+    const PairLegFeatures& secondFeatures = tauFeatures[bestPositions.second];
     finalState_ = TauTauFinalState::tt;
-    ttPair_ = pair<Tau, Tau>({taus_[pairIndex[indexSorted[0]].first], taus_[pairIndex[indexSorted[0]].second]});
+    pairIndices_ = pair<size_t, size_t>(firstFeatures.index, secondFeatures.index);
+    pairSortScores_ = pair<SortScore, SortScore>({
+        SortScore{firstFeatures.isoScore, firstFeatures.pt},
+        SortScore{secondFeatures.isoScore, secondFeatures.pt}
+    });
 
     // return that algorithm has been run successfully
     return true;
 }
 
 
-}; // end namespace tautau_selection_reco
\ No newline at end of file
+}; // end namespace tautau_selection_reco
@@ -1,4 +1,6 @@
 #include <cmath>
+#include <mutex>
+#include <vector>
 
 #include "Math/LorentzVector.h"
 #include "TauAnalysis/TauTriggerNtuples/interface/util.h"
@@ -29,7 +31,291 @@ const bool approxEqual(const double& value1, const double& value2, const double&
 
 
 const double getDeltaR(const LorentzVector<PxPyPzE4D<double>>& p1, const LorentzVector<PxPyPzE4D<double>>& p2) {
-    return sqrt(pow(p1.eta() - p2.eta(), 2) + pow(p1.phi() - p2.phi(), 2));
+    return sqrt(deltaR2(p1.eta(), p1.phi(), p2.eta(), p2.phi()));
+}
+
+
+void KinematicsSoA::clear() {
+    pt.clear();
+    eta.clear();
+    phi.clear();
+    mass.clear();
+}
+
+
+void KinematicsSoA::reserve(const size_t& size) {
+    pt.reserve(size);
+    eta.reserve(size);
+    phi.reserve(size);
+    mass.reserve(size);
+}
+
+
+const size_t KinematicsSoA::size() const {
+    return pt.size();
+}
+
+
+// the kernels below are free of branches, comparisons and math library calls apart from sqrtf(), so that the compiler
+// can vectorize the loops of the batch functions without a vector math library or -ffast-math; sqrtf() becomes a
+// single instruction with -fno-math-errno, which the CMSSW compiler flags set. The conversion to int truncates, which
+// rounds to the nearest integer after adding +-0.5
+
+static inline float deltaPhiKernel(const float phi1, const float phi2) {
+    const float twoPi = 2.f * static_cast<float>(M_PI);
+    const float delta = phi1 - phi2;
+    return delta - twoPi * static_cast<float>(static_cast<int>(delta / twoPi + copysignf(0.5f, delta)));
+}
+
+
+// max(value, 0) without a comparison, fmaxf() is not vectorized as it has to handle NaNs
+static inline float positivePart(const float value) {
+    return 0.5f * (value + fabsf(value));
+}
+
+
+static inline float deltaR2Kernel(const float eta1, const float phi1, const float eta2, const float phi2) {
+    const float deltaEta = eta1 - eta2;
+    const float deltaPhi = deltaPhiKernel(phi1, phi2);
+    return deltaEta * deltaEta + deltaPhi * deltaPhi;
+}
+
+
+static inline float invariantMassKernel(
+    const float px1, const float py1, const float pz1, const float energy1, const float mass1,
+    const float px2, const float py2, const float pz2, const float energy2, const float mass2
+) {
+    // m^2 = m1^2 + m2^2 + 2 (E1 E2 - p1 p2), which cancels less than (E1 + E2)^2 - (p1 + p2)^2 for light objects
+    const float mass2Sum = mass1 * mass1 + mass2 * mass2 + 2.f * (energy1 * energy2 - px1 * px2 - py1 * py2 - pz1 * pz2);
+    return sqrtf(positivePart(mass2Sum));
+}
+
+
+static inline float transverseMassKernel(const float pt1, const float sinHalfPhi1, const float cosHalfPhi1, const float pt2, const float sinHalfPhi2, const float cosHalfPhi2) {
+    // 2 pt1 pt2 (1 - cos(delta phi)) = 4 pt1 pt2 sin^2(delta phi / 2), which does not cancel for small delta phi
+    const float sinHalfDeltaPhi = sinHalfPhi1 * cosHalfPhi2 - cosHalfPhi1 * sinHalfPhi2;
+    return 2.f * sqrtf(pt1 * pt2) * fabsf(sinHalfDeltaPhi);
+}
+
+
+/*
+ * Components of a collection that the mass kernels need. The trigonometric and hyperbolic functions are evaluated once
+ * per object in the scalar loops of toCartesian() and toHalfAngles(), the pair loops of the mass functions then only run
+ * the kernels above.
+ */
+struct CartesianSoA {
+    vector<float> px;
+    vector<float> py;
+    vector<float> pz;
+    vector<float> energy;
+};
+
+
+struct HalfAngleSoA {
+    vector<float> sinHalfPhi;
+    vector<float> cosHalfPhi;
+};
+
+
+static inline void toCartesian(const float pt, const float eta, const float phi, const float mass, float& px, float& py, float& pz, float& energy) {
+    px = pt * cosf(phi);
+    py = pt * sinf(phi);
+    pz = pt * sinhf(eta);
+    const float p = pt * coshf(eta);
+    energy = sqrtf(p * p + mass * mass);
+}
+
+
+// the buffers of both functions are reused by all calls on the same thread
+static const CartesianSoA& toCartesian(const KinematicsSoA& objects) {
+    static thread_local CartesianSoA cartesian;
+    const size_t n = objects.size();
+    cartesian.px.resize(n);
+    cartesian.py.resize(n);
+    cartesian.pz.resize(n);
+    cartesian.energy.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        toCartesian(objects.pt[i], objects.eta[i], objects.phi[i], objects.mass[i],
+            cartesian.px[i], cartesian.py[i], cartesian.pz[i], cartesian.energy[i]);
+    }
+    return cartesian;
+}
+
+
+static const HalfAngleSoA& toHalfAngles(const KinematicsSoA& objects) {
+    static thread_local HalfAngleSoA halfAngles;
+    const size_t n = objects.size();
+    halfAngles.sinHalfPhi.resize(n);
+    halfAngles.cosHalfPhi.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        halfAngles.sinHalfPhi[i] = sinf(0.5f * objects.phi[i]);
+        halfAngles.cosHalfPhi[i] = cosf(0.5f * objects.phi[i]);
+    }
+    return halfAngles;
+}
+
+
+const float deltaPhi(const float& phi1, const float& phi2) {
+    // rounding to the nearest multiple of 2 pi also wraps angles outside of [-pi, pi]
+    return deltaPhiKernel(phi1, phi2);
+}
+
+
+const float deltaR2(const float& eta1, const float& phi1, const float& eta2, const float& phi2) {
+    const float deltaEta = eta1 - eta2;
+    const float dPhi = deltaPhi(phi1, phi2);
+    return deltaEta * deltaEta + dPhi * dPhi;
+}
+
+
+const double deltaPhi(const double& phi1, const double& phi2) {
+    return remainder(phi1 - phi2, 2. * M_PI);
+}
+
+
+const double deltaR2(const double& eta1, const double& phi1, const double& eta2, const double& phi2) {
+    const double deltaEta = eta1 - eta2;
+    const double dPhi = deltaPhi(phi1, phi2);
+    return deltaEta * deltaEta + dPhi * dPhi;
+}
+
+
+const float invariantMass(
+    const float& pt1, const float& eta1, const float& phi1, const float& mass1,
+    const float& pt2, const float& eta2, const float& phi2, const float& mass2
+) {
+    float px1, py1, pz1, energy1, px2, py2, pz2, energy2;
+    toCartesian(pt1, eta1, phi1, mass1, px1, py1, pz1, energy1);
+    toCartesian(pt2, eta2, phi2, mass2, px2, py2, pz2, energy2);
+    return invariantMassKernel(px1, py1, pz1, energy1, mass1, px2, py2, pz2, energy2, mass2);
+}
+
+
+const float transverseMass(const float& pt1, const float& phi1, const float& pt2, const float& phi2) {
+    return transverseMassKernel(pt1, sinf(0.5f * phi1), cosf(0.5f * phi1), pt2, sinf(0.5f * phi2), cosf(0.5f * phi2));
+}
+
+
+void deltaR2(const float& eta, const float& phi, const KinematicsSoA& objects, vector<float>& result) {
+    const size_t n = objects.size();
+    result.resize(n);
+    const float* etas = objects.eta.data();
+    const float* phis = objects.phi.data();
+    float* out = result.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = deltaR2Kernel(eta, phi, etas[i], phis[i]);
+    }
+}
+
+
+void invariantMass(const float& pt, const float& eta, const float& phi, const float& mass, const KinematicsSoA& objects, vector<float>& result) {
+    const size_t n = objects.size();
+    result.resize(n);
+    float px, py, pz, energy;
+    toCartesian(pt, eta, phi, mass, px, py, pz, energy);
+    const CartesianSoA& cartesian = toCartesian(objects);
+    const float* pxs = cartesian.px.data();
+    const float* pys = cartesian.py.data();
+    const float* pzs = cartesian.pz.data();
+    const float* energies = cartesian.energy.data();
+    const float* masses = objects.mass.data();
+    float* out = result.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = invariantMassKernel(px, py, pz, energy, mass, pxs[i], pys[i], pzs[i], energies[i], masses[i]);
+    }
+}
+
+
+void transverseMass(const float& pt, const float& phi, const KinematicsSoA& objects, vector<float>& result) {
+    const size_t n = objects.size();
+    result.resize(n);
+    const float sinHalfPhi = sinf(0.5f * phi);
+    const float cosHalfPhi = cosf(0.5f * phi);
+    const HalfAngleSoA& halfAngles = toHalfAngles(objects);
+    const float* pts = objects.pt.data();
+    const float* sinHalfPhis = halfAngles.sinHalfPhi.data();
+    const float* cosHalfPhis = halfAngles.cosHalfPhi.data();
+    float* out = result.data();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = transverseMassKernel(pt, sinHalfPhi, cosHalfPhi, pts[i], sinHalfPhis[i], cosHalfPhis[i]);
+    }
+}
+
+
+void deltaR2(const KinematicsSoA& objects1, const KinematicsSoA& objects2, vector<float>& result) {
+    const size_t n1 = objects1.size();
+    const size_t n2 = objects2.size();
+    result.resize(n1 * n2);
+    const float* etas = objects2.eta.data();
+    const float* phis = objects2.phi.data();
+    for (size_t i = 0; i < n1; ++i) {
+        const float eta = objects1.eta[i];
+        const float phi = objects1.phi[i];
+        float* out = result.data() + i * n2;
+        for (size_t j = 0; j < n2; ++j) {
+            out[j] = deltaR2Kernel(eta, phi, etas[j], phis[j]);
+        }
+    }
+}
+
+
+void invariantMass(const KinematicsSoA& objects1, const KinematicsSoA& objects2, vector<float>& result) {
+    const size_t n1 = objects1.size();
+    const size_t n2 = objects2.size();
+    result.resize(n1 * n2);
+    const CartesianSoA& cartesian = toCartesian(objects2);
+    const float* pxs = cartesian.px.data();
+    const float* pys = cartesian.py.data();
+    const float* pzs = cartesian.pz.data();
+    const float* energies = cartesian.energy.data();
+    const float* masses = objects2.mass.data();
+    for (size_t i = 0; i < n1; ++i) {
+        const float mass = objects1.mass[i];
+        float px, py, pz, energy;
+        toCartesian(objects1.pt[i], objects1.eta[i], objects1.phi[i], mass, px, py, pz, energy);
+        float* out = result.data() + i * n2;
+        for (size_t j = 0; j < n2; ++j) {
+            out[j] = invariantMassKernel(px, py, pz, energy, mass, pxs[j], pys[j], pzs[j], energies[j], masses[j]);
+        }
+    }
+}
+
+
+void transverseMass(const KinematicsSoA& objects1, const KinematicsSoA& objects2, vector<float>& result) {
+    const size_t n1 = objects1.size();
+    const size_t n2 = objects2.size();
+    result.resize(n1 * n2);
+    const HalfAngleSoA& halfAngles = toHalfAngles(objects2);
+    const float* pts = objects2.pt.data();
+    const float* sinHalfPhis = halfAngles.sinHalfPhi.data();
+    const float* cosHalfPhis = halfAngles.cosHalfPhi.data();
+    for (size_t i = 0; i < n1; ++i) {
+        const float pt = objects1.pt[i];
+        const float sinHalfPhi = sinf(0.5f * objects1.phi[i]);
+        const float cosHalfPhi = cosf(0.5f * objects1.phi[i]);
+        float* out = result.data() + i * n2;
+        for (size_t j = 0; j < n2; ++j) {
+            out[j] = transverseMassKernel(pt, sinHalfPhi, cosHalfPhi, pts[j], sinHalfPhis[j], cosHalfPhis[j]);
+        }
+    }
+}
+
+
+void compensatedAdd(double& sum, double& compensation, const double& value) {
+    const double newSum = sum + value;
+    // the lost low-order bits are those of the smaller of the two summands
+    if (abs(sum) >= abs(value)) {
+        compensation += (sum - newSum) + value;
+    } else {
+        compensation += (value - newSum) + sum;
+    }
+    sum = newSum;
+}
+
+
+mutex& getTFileServiceMutex() {
+    static mutex tFileServiceMutex;
+    return tFileServiceMutex;
 }
 
 
@@ -0,0 +1,190 @@
+// system include files
+#include <cmath>
+#include <string>
+#include <vector>
+
+// user include files
+#include <cppunit/extensions/HelperMacros.h>
+#include "Utilities/Testing/interface/CppUnit_testdriver.icpp"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "TauAnalysis/TauTriggerNtuples/interface/HLTPathSelector.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/tautau_selection_gen.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/TriggerObjectMatcher.h"
+#include "TauAnalysis/TauTriggerNtuples/interface/util.h"
+
+using namespace std;
+using namespace tautau_selection_gen;
+
+
+/*
+ * Unit tests of the framework-independent helpers of the package.
+ */
+class TestTauTriggerNtuples : public CppUnit::TestFixture {
+
+    CPPUNIT_TEST_SUITE(TestTauTriggerNtuples);
+    CPPUNIT_TEST(testTauPairFinalState);
+    CPPUNIT_TEST(testHLTPathSelector);
+    CPPUNIT_TEST(testTriggerObjectMatcher);
+    CPPUNIT_TEST(testCompensatedAdd);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+    void tearDown() {}
+
+    void testTauPairFinalState();
+    void testHLTPathSelector();
+    void testTriggerObjectMatcher();
+    void testCompensatedAdd();
+}; // end class TestTauTriggerNtuples
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestTauTriggerNtuples);
+
+
+void TestTauTriggerNtuples::testTauPairFinalState() {
+    // every pair of decays has to give the same final state for both orders of the legs
+    const TauFinalState legs[6][2] = {
+        {TauFinalState::tauToE, TauFinalState::tauToT},
+        {TauFinalState::tauToM, TauFinalState::tauToT},
+        {TauFinalState::tauToT, TauFinalState::tauToT},
+        {TauFinalState::tauToE, TauFinalState::tauToE},
+        {TauFinalState::tauToM, TauFinalState::tauToM},
+        {TauFinalState::tauToE, TauFinalState::tauToM}
+    };
+    const HZGammaFinalState finalStates[6] = {
+        HZGammaFinalState::et,
+        HZGammaFinalState::mt,
+        HZGammaFinalState::tt,
+        HZGammaFinalState::ee,
+        HZGammaFinalState::mm,
+        HZGammaFinalState::em
+    };
+    for (size_t i = 0; i < 6; ++i) {
+        CPPUNIT_ASSERT_EQUAL(finalStates[i], getTauPairFinalState(legs[i][0], legs[i][1]));
+        CPPUNIT_ASSERT_EQUAL(finalStates[i], getTauPairFinalState(legs[i][1], legs[i][0]));
+    }
+
+    // a single unknown decay makes the pair unknown
+    const TauFinalState knownLegs[3] = {TauFinalState::tauToE, TauFinalState::tauToM, TauFinalState::tauToT};
+    for (const TauFinalState& leg : knownLegs) {
+        CPPUNIT_ASSERT_EQUAL(HZGammaFinalState::unknown, getTauPairFinalState(leg, TauFinalState::tauToUnknown));
+        CPPUNIT_ASSERT_EQUAL(HZGammaFinalState::unknown, getTauPairFinalState(TauFinalState::tauToUnknown, leg));
+    }
+    CPPUNIT_ASSERT_EQUAL(HZGammaFinalState::unknown, getTauPairFinalState(TauFinalState::tauToUnknown, TauFinalState::tauToUnknown));
+}
+
+
+void TestTauTriggerNtuples::testHLTPathSelector() {
+    const HLTPathSelector selector({
+        "HLT_IsoMu24",
+        "HLT_Ele32_WPTight_Gsf",
+        "HLT_DoubleMediumChargedIsoPFTau*35_Trk1_eta2p1_Reg",
+        "HLT_IsoMu2?_eta2p1_LooseChargedIsoPFTau20_*"
+    });
+
+    // exact selections match any version, but only the full name without the version
+    CPPUNIT_ASSERT(selector.isSelected("HLT_IsoMu24_v4"));
+    CPPUNIT_ASSERT(selector.isSelected("HLT_IsoMu24_v13"));
+    CPPUNIT_ASSERT(selector.isSelected("HLT_Ele32_WPTight_Gsf_v1"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu24_eta2p1_v4"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu2_v4"));
+
+    // paths without a version suffix are never selected
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu24"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu24_v"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu24_x4"));
+
+    // '*' matches any sequence including an empty one, '?' exactly one character
+    CPPUNIT_ASSERT(selector.isSelected("HLT_DoubleMediumChargedIsoPFTau35_Trk1_eta2p1_Reg_v2"));
+    CPPUNIT_ASSERT(selector.isSelected("HLT_DoubleMediumChargedIsoPFTauHPS35_Trk1_eta2p1_Reg_v2"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_DoubleMediumChargedIsoPFTau35_Trk1_eta2p1_v2"));
+    CPPUNIT_ASSERT(selector.isSelected("HLT_IsoMu20_eta2p1_LooseChargedIsoPFTau20_SingleL1_v5"));
+    CPPUNIT_ASSERT(selector.isSelected("HLT_IsoMu24_eta2p1_LooseChargedIsoPFTau20_SingleL1_v5"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu2_eta2p1_LooseChargedIsoPFTau20_SingleL1_v5"));
+    CPPUNIT_ASSERT(!selector.isSelected("HLT_IsoMu240_eta2p1_LooseChargedIsoPFTau20_SingleL1_v5"));
+
+    // an empty selector selects nothing
+    CPPUNIT_ASSERT(!HLTPathSelector().isSelected("HLT_IsoMu24_v4"));
+}
+
+
+void TestTauTriggerNtuples::testTriggerObjectMatcher() {
+    CPPUNIT_ASSERT_THROW(TriggerObjectMatcher(0.), cms::Exception);
+    CPPUNIT_ASSERT_THROW(TriggerObjectMatcher(-0.5), cms::Exception);
+
+    TriggerObjectMatcher matcher(0.5);
+    vector<size_t> matches;
+
+    // no objects, no matches
+    matcher.build();
+    matcher.match(0., 0., matches);
+    CPPUNIT_ASSERT(matches.empty());
+
+    // objects on both sides of phi = +-pi, at the border of the cone and beyond the eta range of the grid
+    const double etas[6] = {0., 0., 0., 0.3, 2., 6.};
+    const double phis[6] = {0., 3.1, -3.1, 0.45, 0., 0.};
+    for (size_t i = 0; i < 6; ++i) {
+        CPPUNIT_ASSERT_EQUAL(i, matcher.add(etas[i], phis[i]));
+    }
+    matcher.build();
+    CPPUNIT_ASSERT_EQUAL(size_t(6), matcher.size());
+
+    matcher.match(0., 3.13, matches);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), matches.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), matches[0]);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), matches[1]);
+
+    // delta R of the fourth object is about 0.541
+    matcher.match(0., 0., matches);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), matches.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(0), matches[0]);
+
+    matcher.match(5.8, 0.1, matches);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), matches.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(5), matches[0]);
+
+    // the grid has to find the same objects as a comparison with all objects
+    matcher.clear();
+    for (size_t i = 0; i < 200; ++i) {
+        matcher.add(-3. + 0.03 * i, -M_PI + 0.0314 * ((37 * i) % 200));
+    }
+    matcher.build();
+    for (size_t i = 0; i < 50; ++i) {
+        const double eta = -2.5 + 0.1 * i;
+        const double phi = -M_PI + 0.1257 * ((13 * i) % 50);
+        matcher.match(eta, phi, matches);
+        vector<size_t> expected;
+        for (size_t j = 0; j < matcher.size(); ++j) {
+            if (matcher.deltaR2(j, eta, phi) < 0.25) {
+                expected.push_back(j);
+            }
+        }
+        CPPUNIT_ASSERT(matches == expected);
+    }
+}
+
+
+void TestTauTriggerNtuples::testCompensatedAdd() {
+    // small summands after a large one are lost in a plain sum but kept in the compensation
+    double sum = 1.;
+    double compensation = 0.;
+    double plainSum = 1.;
+    for (size_t i = 0; i < 1000000; ++i) {
+        util::compensatedAdd(sum, compensation, 1.0e-16);
+        plainSum += 1.0e-16;
+    }
+    CPPUNIT_ASSERT_EQUAL(1., plainSum);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1. + 1.0e-10, sum + compensation, 1.0e-15);
+
+    // a large summand after small ones and summands that cancel
+    sum = 0.;
+    compensation = 0.;
+    const double values[4] = {1.0e-16, 1.0e100, 1.0, -1.0e100};
+    for (const double& value : values) {
+        util::compensatedAdd(sum, compensation, value);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1. + 1.0e-16, sum + compensation, 1.0e-16);
+}